@@ -0,0 +1,41 @@
+$srcDir =	[String]$pwd + "\src\"		# Directory for source files
+$benchDir =	[String]$pwd + "\bench\"	# Directory for benchmark files
+$buildDir =	[String]$pwd + "\build\"	# Ouput directory
+$outFile =	"MeshBenchmark.exe"			# Executable name
+
+$compilerFlags =
+	"-O2",
+	"-std=c17",
+	"-Wall",
+	"-Wextra",
+	"-Werror",
+	"-Wno-unused-parameter",
+    "-Wno-unused-variable",
+    "-Wno-unused-function",
+    ("-I" + [String]$pwd + "\src"),
+    ("-I" + [String]$pwd + "\lib\cglm\include"),
+    ("-I" + [String]$pwd + "\lib\")
+$compilerDefines =
+	"-D_CRT_SECURE_NO_WARNINGS"
+
+# The benchmark includes Chunk.c itself and has its own main so Chunk.c and Main.c are left out
+$files =
+	($benchDir + "MeshBenchmark.c"),
+	($srcDir + "Clock.c"),
+	($srcDir + "DynamicArray.c"),
+	($srcDir + "Frustum.c"),
+	($srcDir + "OpenGL.c"),
+	($srcDir + "Simplex.c"),
+	($srcDir + "Transform.c"),
+	($srcDir + "UploadRing.c"),
+	($srcDir + "VertexArena.c")
+
+Write-Output Compiling: @files # Output the files that we are compiling to the console
+
+if (!(Test-Path buildDir)) {								# If the build directory does not exist
+	$unused = New-Item $buildDir -ItemType Directory -Force	# Create it
+}
+
+Push-Location $buildDir										# Go into the build directory
+clang @compilerDefines @compilerFlags -o $outFile @files -static -lUser32 -lOpenGL32 -lGdi32 # Build the benchmark
+Pop-Location												# Exit the build directory
@@ -0,0 +1,168 @@
+// Compares the chunk meshers against a baseline with the same quads but push-per-vertex output, run with BuildBenchmark.ps1.
+// Both sides do the rest of Chunk_GenerateMesh's work too, so the difference is only how the output is built
+
+// Included directly so the benchmark can reach the meshers, which are internal to Chunk.c
+#include "../src/Chunk.c"
+#include "Clock.h"
+
+#include <stdio.h>
+
+// Before: every vertex was pushed one at a time, growing the array as it went
+static void Baseline_PushQuad(Chunk* chunk, BlockFace face, const u32 start[3], const u32 size[3], u8 ao) {
+    Vertex vertices[4];
+    Chunk_WriteQuad(chunk, vertices, face, start, size, ao);
+    for (u32 i = 0; i < 4; i++) {
+        DynamicArrayPush(chunk->Mesh.Vertices, vertices[i]);
+    }
+}
+
+// The same work Chunk_GenerateMesh does before it meshes
+static void Baseline_Prepare(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    Chunk_FillSolidGrid(chunk, neighbors);
+    memset(chunk->DirtySlices, 0, sizeof(chunk->DirtySlices));
+    Chunk_FindFaceConnections(chunk, chunk->Mesh.FaceConnections);
+}
+
+static void Baseline_GeneratePerFaceMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    Baseline_Prepare(chunk, neighbors);
+    ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+
+    for (u32 x = 0; x < chunk->Width; x++) {
+        for (u32 y = 0; y < chunk->Height; y++) {
+            for (u32 z = 0; z < chunk->Depth; z++) {
+                u32 index = x + (y * chunk->Width) + (z * chunk->Width * chunk->Height);
+                if (chunk->Blocks[index] == BlockID_Air) {
+                    continue;
+                }
+
+                for (BlockFace face = 0; face < BlockFace_Count; face++) {
+                    s32 neighbor[3] = { cast(s32) x, cast(s32) y, cast(s32) z };
+                    neighbor[BlockFaces[face].Axis] += BlockFaces[face].Direction;
+                    if (Chunk_GetNeighborBlock(chunk, neighbors, neighbor[0], neighbor[1], neighbor[2]) == BlockID_Air) {
+                        const u32 start[3] = { x, y, z };
+                        const u32 size[3] = { 1, 1, 1 };
+                        Baseline_PushQuad(chunk, face, start, size, Chunk_GetFaceAO(&grid, face, start));
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void Baseline_GenerateGreedyMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    Baseline_Prepare(chunk, neighbors);
+    ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+
+    ChunkQuad* quads = NULL;
+    u32 quadCount = Chunk_FindGreedyQuads(chunk, &grid, &quads);
+    for (u32 i = 0; i < quadCount; i++) {
+        const u32 start[3] = { quads[i].Start[0], quads[i].Start[1], quads[i].Start[2] };
+        const u32 size[3] = { quads[i].Size[0], quads[i].Size[1], quads[i].Size[2] };
+        Baseline_PushQuad(chunk, quads[i].Face, start, size, quads[i].AO);
+    }
+    free(quads);
+}
+
+#define CHUNK_SIZE 8
+#define CHUNKS_X 12
+#define CHUNKS_Y 6
+#define CHUNKS_Z 12
+#define ITERATIONS 10
+
+typedef void (*MeshFunction)(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]);
+
+static Chunk* GetChunk(Chunk* chunks, s64 x, s64 y, s64 z) {
+    if (x < 0 || x >= CHUNKS_X || y < 0 || y >= CHUNKS_Y || z < 0 || z >= CHUNKS_Z) {
+        return NULL;
+    }
+    return &chunks[x + (y * CHUNKS_X) + (z * CHUNKS_X * CHUNKS_Y)];
+}
+
+// Meshes every chunk starting from a fresh vertex array, the same as a newly created chunk, and returns the average milliseconds per chunk
+static f64 RunBenchmark(Chunk* chunks, ChunkMeshMode meshMode, MeshFunction function, u64* outQuadCount) {
+    Clock clock = {};
+    Clock_Start(&clock);
+
+    u64 quadCount = 0;
+    for (u64 iteration = 0; iteration < ITERATIONS; iteration++) {
+        quadCount = 0;
+        for (s64 z = 0; z < CHUNKS_Z; z++) {
+            for (s64 y = 0; y < CHUNKS_Y; y++) {
+                for (s64 x = 0; x < CHUNKS_X; x++) {
+                    Chunk* chunk = GetChunk(chunks, x, y, z);
+                    Chunk* neighbors[CHUNK_NEIGHBOR_COUNT] = {};
+                    for (s32 i = 0; i < CHUNK_NEIGHBOR_COUNT; i++) {
+                        if (i != CHUNK_NEIGHBOR_CENTER) {
+                            neighbors[i] = GetChunk(chunks, x + (i % 3) - 1, y + ((i / 3) % 3) - 1, z + (i / 9) - 1);
+                        }
+                    }
+
+                    DynamicArrayDestroy(chunk->Mesh.Vertices);
+                    chunk->Mesh.Vertices = DynamicArrayCreate(Vertex);
+                    chunk->MeshMode = meshMode;
+                    function(chunk, neighbors);
+                    quadCount += DynamicArrayLength(chunk->Mesh.Vertices) / 4;
+                }
+            }
+        }
+    }
+
+    Clock_Update(&clock);
+    *outQuadCount = quadCount;
+    return (clock.Elapsed * 1000.0) / (ITERATIONS * CHUNKS_X * CHUNKS_Y * CHUNKS_Z);
+}
+
+int main(int argc, char** argv) {
+    Clock_Init();
+
+    Chunk* chunks = malloc(CHUNKS_X * CHUNKS_Y * CHUNKS_Z * sizeof(Chunk));
+    for (s64 z = 0; z < CHUNKS_Z; z++) {
+        for (s64 y = 0; y < CHUNKS_Y; y++) {
+            for (s64 x = 0; x < CHUNKS_X; x++) {
+                Chunk* chunk = GetChunk(chunks, x, y, z);
+                *chunk = (Chunk){
+                    .Position = { x * CHUNK_SIZE, (y - CHUNKS_Y / 2) * CHUNK_SIZE, z * CHUNK_SIZE },
+                    .Width = CHUNK_SIZE,
+                    .Height = CHUNK_SIZE,
+                    .Depth = CHUNK_SIZE,
+                    .Blocks = DynamicArrayCreate_(CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE, sizeof(u16)),
+                    .Solid = malloc((CHUNK_SIZE + 2) * (CHUNK_SIZE + 2) * (CHUNK_SIZE + 2)),
+                    .Mesh = {
+                        .Vertices = DynamicArrayCreate(Vertex),
+                        .SliceRanges = calloc(BlockFace_Count * CHUNK_SIZE, sizeof(ChunkSliceRange)),
+                    },
+                };
+                Chunk_GenerateBlocks(chunk);
+            }
+        }
+    }
+
+    static const struct {
+        const char* Name;
+        ChunkMeshMode MeshMode;
+        MeshFunction Before;
+    } Meshers[] = {
+        { "Per Face", ChunkMeshMode_PerFace, Baseline_GeneratePerFaceMesh },
+        { "Greedy",   ChunkMeshMode_Greedy,  Baseline_GenerateGreedyMesh  },
+    };
+
+    printf("%d chunks of %d^3, %d iterations\n", CHUNKS_X * CHUNKS_Y * CHUNKS_Z, CHUNK_SIZE, ITERATIONS);
+    for (u64 i = 0; i < sizeof(Meshers) / sizeof(Meshers[0]); i++) {
+        u64 beforeQuads = 0, afterQuads = 0;
+        f64 before = RunBenchmark(chunks, Meshers[i].MeshMode, Meshers[i].Before, &beforeQuads);
+        f64 after = RunBenchmark(chunks, Meshers[i].MeshMode, Chunk_GenerateMesh, &afterQuads);
+        ASSERT(beforeQuads == afterQuads);
+
+        printf("%-8s  quads: %8llu  before (same quads, push per vertex): %8.4f ms/chunk  after: %8.4f ms/chunk  speedup: %.2fx\n",
+            Meshers[i].Name, afterQuads, before, after, before / after);
+    }
+
+    for (u64 i = 0; i < CHUNKS_X * CHUNKS_Y * CHUNKS_Z; i++) {
+        DynamicArrayDestroy(chunks[i].Blocks);
+        free(chunks[i].Solid);
+        DynamicArrayDestroy(chunks[i].Mesh.Vertices);
+        free(chunks[i].Mesh.SliceRanges);
+    }
+    free(chunks);
+    return 0;
+}
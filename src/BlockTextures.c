@@ -0,0 +1,150 @@
+#include "BlockTextures.h"
+#include "Chunk.h"
+#include "Clock.h"
+#include "stb_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Windows.h>
+
+#define BLOCK_TEXTURE_SIZE 16
+#define BLOCK_TEXTURE_MIP_LEVELS 5 // Down to 1x1
+#define BLOCK_TEXTURE_LAYER_SIZE (BLOCK_TEXTURE_SIZE * BLOCK_TEXTURE_SIZE * 4)
+
+// The image of each block, its layer in the array is its block id
+static const char* BlockTextureFiles[] = {
+    [BlockID_Air]   = NULL,
+    [BlockID_Stone] = "stone.png",
+};
+#define BLOCK_TEXTURE_LAYER_COUNT (sizeof(BlockTextureFiles) / sizeof(BlockTextureFiles[0]))
+
+typedef struct BlockTextures {
+    GLuint Texture;
+
+    HANDLE Thread; // NULL once the decoded images have been uploaded
+    const char* Directory;
+
+    // Written by the decode thread until it finishes
+    u8* Pixels; // RGBA8, every layer one after another
+    u32 FileCount;
+    u32 LoadedCount;
+    f64 DecodeTime;
+} BlockTextures;
+
+// Light gray like the untextured blocks were, with a darker edge so the blocks stay apart
+static void BlockTextures_GenerateFallback(u8* pixels) {
+    for (u32 y = 0; y < BLOCK_TEXTURE_SIZE; y++) {
+        for (u32 x = 0; x < BLOCK_TEXTURE_SIZE; x++) {
+            b8 edge = x == 0 || y == 0 || x == BLOCK_TEXTURE_SIZE - 1 || y == BLOCK_TEXTURE_SIZE - 1;
+            u8* pixel = &pixels[(y * BLOCK_TEXTURE_SIZE + x) * 4];
+            pixel[0] = pixel[1] = pixel[2] = edge ? 170 : 204;
+            pixel[3] = 255;
+        }
+    }
+}
+
+static DWORD WINAPI BlockTextures_ThreadMain(LPVOID userData) {
+    BlockTextures* textures = userData;
+
+    Clock clock = {};
+    Clock_Start(&clock);
+
+    for (u32 layer = 0; layer < BLOCK_TEXTURE_LAYER_COUNT; layer++) {
+        if (!BlockTextureFiles[layer]) {
+            continue;
+        }
+        textures->FileCount++;
+
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s", textures->Directory, BlockTextureFiles[layer]);
+
+        s32 width = 0, height = 0, channels = 0;
+        u8* image = stbi_load(path, &width, &height, &channels, 4);
+        if (!image) {
+            printf("Unable to load block texture '%s': %s\n", path, stbi_failure_reason());
+            continue;
+        }
+
+        if (width == BLOCK_TEXTURE_SIZE && height == BLOCK_TEXTURE_SIZE) {
+            memcpy(&textures->Pixels[layer * BLOCK_TEXTURE_LAYER_SIZE], image, BLOCK_TEXTURE_LAYER_SIZE);
+            textures->LoadedCount++;
+        } else {
+            printf("Block texture '%s' is %dx%d, expected %dx%d\n", path, width, height, BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_SIZE);
+        }
+
+        stbi_image_free(image);
+    }
+
+    Clock_Update(&clock);
+    textures->DecodeTime = clock.Elapsed;
+    return 0;
+}
+
+static void BlockTextures_Upload(BlockTextures* textures) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textures->Texture);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_LAYER_COUNT, GL_RGBA, GL_UNSIGNED_BYTE, textures->Pixels);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+BlockTextures* BlockTextures_Create(const char* directory) {
+    BlockTextures* textures = malloc(sizeof(BlockTextures));
+    *textures = (BlockTextures){
+        .Directory = directory,
+        .Pixels = malloc(BLOCK_TEXTURE_LAYER_COUNT * BLOCK_TEXTURE_LAYER_SIZE),
+    };
+
+    // Layers keep the fallback when their image fails to load
+    for (u32 layer = 0; layer < BLOCK_TEXTURE_LAYER_COUNT; layer++) {
+        BlockTextures_GenerateFallback(&textures->Pixels[layer * BLOCK_TEXTURE_LAYER_SIZE]);
+    }
+
+    // Texture coordinates are in blocks, repeating lets a merged face tile the texture without it having to be in an atlas
+    glGenTextures(1, &textures->Texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textures->Texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, BLOCK_TEXTURE_MIP_LEVELS, GL_RGBA8, BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_LAYER_COUNT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    BlockTextures_Upload(textures);
+
+    textures->Thread = CreateThread(NULL, 0, BlockTextures_ThreadMain, textures, 0, NULL);
+    return textures;
+}
+
+void BlockTextures_Destroy(BlockTextures* textures) {
+    if (textures->Thread) {
+        WaitForSingleObject(textures->Thread, INFINITE);
+        CloseHandle(textures->Thread);
+    }
+
+    glDeleteTextures(1, &textures->Texture);
+    free(textures->Pixels);
+    free(textures);
+}
+
+void BlockTextures_Update(BlockTextures* textures) {
+    if (!textures->Thread || WaitForSingleObject(textures->Thread, 0) != WAIT_OBJECT_0) {
+        return;
+    }
+
+    CloseHandle(textures->Thread);
+    textures->Thread = NULL;
+
+    Clock uploadClock = {};
+    Clock_Start(&uploadClock);
+    BlockTextures_Upload(textures);
+    Clock_Update(&uploadClock);
+
+    free(textures->Pixels);
+    textures->Pixels = NULL;
+
+    printf("\nBlock Textures: %u of %u loaded, decode %f ms, upload %f ms\n", textures->LoadedCount, textures->FileCount,
+        textures->DecodeTime * 1000.0, uploadClock.Elapsed * 1000.0);
+}
+
+GLuint BlockTextures_GetTexture(BlockTextures* textures) {
+    return textures->Texture;
+}
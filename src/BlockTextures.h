@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "OpenGL.h"
+
+// The block textures in a GL_TEXTURE_2D_ARRAY with one layer per block id.
+// The images are decoded on a background thread, until they are uploaded every layer holds a generated fallback texture
+typedef struct BlockTextures BlockTextures;
+
+// Starts decoding the images in the directory, the texture can be drawn with right away
+BlockTextures* BlockTextures_Create(const char* directory);
+// Waits for the decode thread if it is still running
+void BlockTextures_Destroy(BlockTextures* textures);
+
+// Uploads the decoded images and regenerates the mipmaps once the decode thread has finished, call once per frame
+void BlockTextures_Update(BlockTextures* textures);
+GLuint BlockTextures_GetTexture(BlockTextures* textures);
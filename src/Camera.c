@@ -0,0 +1,7 @@
+#include "Camera.h"
+
+void Camera_UpdateMatrices(Camera* camera) {
+    Transform_ToMatrix(&camera->Transform, camera->ViewMatrix);
+    glm_mat4_inv(camera->ViewMatrix, camera->ViewMatrix);
+    glm_mat4_mul(camera->ProjectionMatrix, camera->ViewMatrix, camera->ViewProjectionMatrix);
+}
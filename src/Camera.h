@@ -6,4 +6,9 @@
 typedef struct Camera {
     Transform Transform;
     mat4 ProjectionMatrix;
+    // Updated from the transform once per frame by Camera_UpdateMatrices
+    mat4 ViewMatrix;
+    mat4 ViewProjectionMatrix;
 } Camera;
+
+void Camera_UpdateMatrices(Camera* camera);
@@ -1,6 +1,9 @@
 #include "Chunk.h"
 #include "DynamicArray.h"
 #include "Simplex.h"
+#include "VertexArena.h"
+#include "UploadRing.h"
+#include "Frustum.h"
 
 #include <memory.h>
 #include <stdlib.h>
@@ -22,570 +25,1720 @@ static u16 GetBlock(vec3 position) {
     }
 }
 
-void Chunk_Create(Chunk* chunk, s64 x, s64 y, s64 z, u32 width, u32 height, u32 depth, GLuint shader) {
+typedef struct BlockFaceInfo {
+    u32 Axis;
+    s32 Direction;
+    u8 Corners[4][3];
+    u8 TexCoords[4][2];
+    u32 TexCoordAxes[2];
+} BlockFaceInfo;
+
+// A corner of 0 is the -0.5 side of the block and 1 is the +0.5 side, the face indices must match the normals in the chunk vertex shader.
+// The corners are ordered so that the shared quad indices (0, 1, 2, 0, 2, 3) give every face the right winding
+static const BlockFaceInfo BlockFaces[BlockFace_Count] = {
+    [BlockFace_Top] = {
+        .Axis = 1,
+        .Direction = 1,
+        .Corners = { { 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 } },
+        .TexCoords = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } },
+        .TexCoordAxes = { 0, 2 },
+    },
+    [BlockFace_Bottom] = {
+        .Axis = 1,
+        .Direction = -1,
+        .Corners = { { 0, 0, 1 }, { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 } },
+        .TexCoords = { { 1, 1 }, { 1, 0 }, { 0, 0 }, { 0, 1 } },
+        .TexCoordAxes = { 0, 2 },
+    },
+    [BlockFace_Left] = {
+        .Axis = 0,
+        .Direction = -1,
+        .Corners = { { 0, 1, 0 }, { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 } },
+        .TexCoords = { { 1, 1 }, { 1, 0 }, { 0, 0 }, { 0, 1 } },
+        .TexCoordAxes = { 2, 1 },
+    },
+    [BlockFace_Right] = {
+        .Axis = 0,
+        .Direction = 1,
+        .Corners = { { 1, 1, 0 }, { 1, 1, 1 }, { 1, 0, 1 }, { 1, 0, 0 } },
+        .TexCoords = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } },
+        .TexCoordAxes = { 2, 1 },
+    },
+    [BlockFace_Front] = {
+        .Axis = 2,
+        .Direction = 1,
+        .Corners = { { 0, 1, 1 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 } },
+        .TexCoords = { { 1, 1 }, { 1, 0 }, { 0, 0 }, { 0, 1 } },
+        .TexCoordAxes = { 0, 1 },
+    },
+    [BlockFace_Back] = {
+        .Axis = 2,
+        .Direction = -1,
+        .Corners = { { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 }, { 0, 0, 0 } },
+        .TexCoords = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } },
+        .TexCoordAxes = { 0, 1 },
+    },
+};
+
+// Runs the generator for a chunk local block, a block of a chunk with a higher Lod covers 2^Lod world blocks along each axis.
+// It is solid when at least half of 8 of those blocks spread evenly through it are, which is all of them at Lod 1,
+// so the caves and overhangs keep their shape across Lods instead of each Lod sampling one block of its own
+static u16 Chunk_SampleBlock(Chunk* chunk, s32 x, s32 y, s32 z) {
+    s32 scale = 1 << chunk->Lod;
+    vec3 origin = {
+        cast(f32) chunk->Position.x + cast(f32) (x * scale) - (cast(f32) (chunk->Width * scale) * 0.5f),
+        cast(f32) chunk->Position.y + cast(f32) (y * scale) - (cast(f32) (chunk->Height * scale) * 0.5f),
+        cast(f32) chunk->Position.z + cast(f32) (z * scale) - (cast(f32) (chunk->Depth * scale) * 0.5f),
+    };
+    if (scale == 1) {
+        return GetBlock(origin);
+    }
+
+    u32 solidCount = 0;
+    for (s32 i = 0; i < 8; i++) {
+        vec3 position = {
+            origin[0] + cast(f32) (scale / 4 + (i & 1) * (scale / 2)),
+            origin[1] + cast(f32) (scale / 4 + ((i >> 1) & 1) * (scale / 2)),
+            origin[2] + cast(f32) (scale / 4 + ((i >> 2) & 1) * (scale / 2)),
+        };
+        if (GetBlock(position) != BlockID_Air) {
+            solidCount++;
+        }
+    }
+    return solidCount >= 4 ? BlockID_Stone : BlockID_Air;
+}
+
+// Returns the block at a chunk local position that may be up to one block outside of the chunk,
+// reading from the loaded neighbor chunk when there is one, diagonal ones included, and only running the generator when there isn't
+static u16 Chunk_GetNeighborBlock(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT], s32 x, s32 y, s32 z) {
+    const s32 size[3] = { cast(s32) chunk->Width, cast(s32) chunk->Height, cast(s32) chunk->Depth };
+
+    // The chunk the block is in relative to this one, and the block's position in that chunk
+    s32 position[3] = { x, y, z };
+    s32 offset[3];
+    for (u32 axis = 0; axis < 3; axis++) {
+        offset[axis] = position[axis] < 0 ? -1 : (position[axis] >= size[axis] ? 1 : 0);
+        position[axis] -= offset[axis] * size[axis];
+    }
+
+    u32 neighborIndex = ChunkNeighbor_Index(offset[0], offset[1], offset[2]);
+    Chunk* neighbor = neighborIndex == CHUNK_NEIGHBOR_CENTER ? chunk : neighbors[neighborIndex];
+    if (neighbor) {
+        ASSERT(neighbor->Width == chunk->Width && neighbor->Height == chunk->Height && neighbor->Depth == chunk->Depth);
+        ASSERT(neighbor->Lod == chunk->Lod);
+        return neighbor->Blocks[position[0] + (position[1] * size[0]) + (position[2] * size[0] * size[1])];
+    }
+
+    return Chunk_SampleBlock(chunk, x, y, z);
+}
+
+void Chunk_GenerateBlocks(Chunk* chunk) {
+    for (u32 x = 0; x < chunk->Width; x++) {
+        for (u32 y = 0; y < chunk->Height; y++) {
+            for (u32 z = 0; z < chunk->Depth; z++) {
+                u32 index = x + (y * chunk->Width) + (z * chunk->Width * chunk->Height);
+                chunk->Blocks[index] = Chunk_SampleBlock(chunk, cast(s32) x, cast(s32) y, cast(s32) z);
+            }
+        }
+    }
+}
+
+// Every quad is drawn with the indices (0, 1, 2, 0, 2, 3) offset by 4 per quad so one index buffer is shared by all chunks
+static GLuint QuadIndexBuffer = 0;
+static u32 QuadIndexBufferQuadCount = 0;
+
+static void Chunk_ReserveQuadIndices(u32 quadCount) {
+    if (quadCount <= QuadIndexBufferQuadCount) {
+        return;
+    }
+
+    u32* indices = malloc(quadCount * 6 * sizeof(u32));
+    for (u32 i = 0; i < quadCount; i++) {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 2;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+
+    if (!QuadIndexBuffer) {
+        glGenBuffers(1, &QuadIndexBuffer);
+    }
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, quadCount * 6 * sizeof(u32), indices, GL_STATIC_DRAW);
+    QuadIndexBufferQuadCount = quadCount;
+
+    free(indices);
+}
+
+static u32 Chunk_GetMaxSize(Chunk* chunk) {
+    u32 maxSize = chunk->Width > chunk->Height ? chunk->Width : chunk->Height;
+    return chunk->Depth > maxSize ? chunk->Depth : maxSize;
+}
+
+// Every chunk's mesh lives in one vertex arena so the whole terrain can be drawn with one vertex array and one multi draw
+static VertexArena ChunkVertexArena = {};
+static GLuint ChunkVertexArray = 0;
+// Meshes are written into the mapped ring and copied into the arena on the GPU
+static UploadRing ChunkUploadRing = {};
+// Per draw chunk placement read by the vertex shader through the instanced attribute, selected with the command's base instance
+static GLuint ChunkDrawDataBuffer = 0;
+static GLuint ChunkDrawCommandBuffer = 0;
+
+// The layout glMultiDrawElementsIndirect reads
+typedef struct DrawElementsIndirectCommand {
+    u32 Count;
+    u32 InstanceCount;
+    u32 FirstIndex;
+    s32 BaseVertex;
+    u32 BaseInstance;
+} DrawElementsIndirectCommand;
+
+// Where the chunk's vertex positions start in the world and how many world blocks one of its blocks covers
+typedef struct ChunkDrawData {
+    f32 Min[3];
+    f32 Scale;
+} ChunkDrawData;
+
+// Rebuilt every frame by Chunk_DrawChunks
+static DrawElementsIndirectCommand* ChunkDrawCommands = NULL;
+static ChunkDrawData* ChunkDrawDatas = NULL;
+// The chunks with something to draw and their bounds, which are tested against the frustum together
+static Chunk** ChunkDrawCandidates = NULL;
+static FrustumBoxes ChunkDrawBounds = {};
+static b8* ChunkDrawVisible = NULL;
+
+// The chunks to draw this frame sorted front to back so nearer terrain fills the depth buffer first and
+// the fragments of what's behind it are rejected before shading
+typedef struct ChunkSortEntry {
+    u32 Key; // The squared distance to the camera as float bits, which sort like unsigned integers since it's never negative
+    Chunk* Chunk;
+} ChunkSortEntry;
+
+static ChunkSortEntry* ChunkSortEntries = NULL;
+static ChunkSortEntry* ChunkSortScratch = NULL;
+
+// Chunks with at least this Lod never get edited, so the ones in the same CHUNK_REGION_SIZE^3 block of the grid of their Lod
+// are merged into one mesh that is drawn with one command instead of a few per chunk. A region is rebuilt from its members'
+// meshes once it has stopped changing for a while, until then its members are drawn on their own
+#define CHUNK_REGION_MIN_LOD 1
+#define CHUNK_REGION_SIZE 4
+
+struct ChunkRegion {
+    s64 Position[3]; // On the grid of regions of the Lod
+    u32 Lod;
+    u32 ChunkSize[3]; // The Width, Height and Depth of the members
+    vec3 Min;         // Where the region's vertex positions start in the world
+    Chunk** Members;
+    ChunkFaceRange FaceRanges[BlockFace_Count];
+    u32 VertexOffset;
+    u32 VertexCapacity;
+    b8 Built;         // The region's mesh has the current mesh of every member
+    u64 ChangedFrame; // The last draw the region's mesh went out of date in
+    u64 DrawFrame;    // The last draw the region's commands were pushed in
+};
+
+static ChunkRegion** ChunkRegions = NULL;
+static Vertex* ChunkRegionVertices = NULL; // Where a region's mesh is put together before it's uploaded
+static const u64 ChunkRegionSettleFrames = 30;
+static const u32 ChunkRegionBuildsPerFrame = 2;
+
+// The boxes are drawn as the 6 faces of a unit cube scaled to the box by the instanced attributes, one draw per occlusion query
+typedef struct ChunkOcclusionBox {
+    f32 Min[3];
+    f32 Max[3];
+} ChunkOcclusionBox;
+
+static GLuint ChunkOcclusionVertexArray = 0;
+static GLuint ChunkOcclusionCornerBuffer = 0;
+static GLuint ChunkOcclusionBoxBuffer = 0;
+static ChunkOcclusionBox* ChunkOcclusionBoxes = NULL;
+static Chunk** ChunkOcclusionTested = NULL;
+// The queries of destroyed chunks, handed to new chunks so streaming doesn't keep generating and deleting query names.
+// A query that is still in flight can be reused, beginning it again replaces the old result
+static GLuint* ChunkIdleQueries = NULL;
+static const u64 ChunkMaxIdleQueries = 1024;
+// Counts the calls to Chunk_DrawChunks
+static u64 ChunkDrawFrame = 0;
+
+// The boxes are grown a bit so the faces of a chunk's mesh that lie on its bounds never hide its own box
+static const f32 ChunkOcclusionBoxPadding = 0.25f;
+
+// The vertex array holds the arena's buffer name, which changes when the arena grows
+static void Chunk_BindVertexArena() {
+    GLState_BindVertexArray(ChunkVertexArray);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkVertexArena.Buffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(Vertex), cast(const void*) offsetof(Vertex, Data0));
+}
+
+static void Chunk_CreateSharedResources() {
+    const u32 InitialArenaVertexCount = 1 << 20;
+    const u64 UploadRingSize = 16 << 20;
+    VertexArena_Create(&ChunkVertexArena, InitialArenaVertexCount);
+    UploadRing_Create(&ChunkUploadRing, UploadRingSize);
+
+    glGenVertexArrays(1, &ChunkVertexArray);
+    Chunk_BindVertexArena();
+
+    glGenBuffers(1, &ChunkDrawDataBuffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkDrawDataBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ChunkDrawData), cast(const void*) offsetof(ChunkDrawData, Min));
+    glVertexAttribDivisor(1, 1);
+
+    glGenBuffers(1, &ChunkDrawCommandBuffer);
+
+    // The cube's faces are wound like block faces so the same face culling keeps the sides facing the camera
+    f32 corners[BlockFace_Count * 4][3];
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        for (u32 corner = 0; corner < 4; corner++) {
+            for (u32 axis = 0; axis < 3; axis++) {
+                corners[face * 4 + corner][axis] = cast(f32) BlockFaces[face].Corners[corner][axis];
+            }
+        }
+    }
+
+    glGenVertexArrays(1, &ChunkOcclusionVertexArray);
+    GLState_BindVertexArray(ChunkOcclusionVertexArray);
+    glGenBuffers(1, &ChunkOcclusionCornerBuffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkOcclusionCornerBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(corners[0]), NULL);
+
+    glGenBuffers(1, &ChunkOcclusionBoxBuffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkOcclusionBoxBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ChunkOcclusionBox), cast(const void*) offsetof(ChunkOcclusionBox, Min));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ChunkOcclusionBox), cast(const void*) offsetof(ChunkOcclusionBox, Max));
+    glVertexAttribDivisor(2, 1);
+
+    ChunkDrawCommands = DynamicArrayCreate(DrawElementsIndirectCommand);
+    ChunkDrawDatas = DynamicArrayCreate(ChunkDrawData);
+    ChunkDrawCandidates = DynamicArrayCreate(Chunk*);
+    FrustumBoxes_Create(&ChunkDrawBounds);
+    ChunkDrawVisible = DynamicArrayCreate(b8);
+    ChunkRegions = DynamicArrayCreate(ChunkRegion*);
+    ChunkRegionVertices = DynamicArrayCreate(Vertex);
+    ChunkSortEntries = DynamicArrayCreate(ChunkSortEntry);
+    ChunkSortScratch = DynamicArrayCreate(ChunkSortEntry);
+    ChunkOcclusionBoxes = DynamicArrayCreate(ChunkOcclusionBox);
+    ChunkOcclusionTested = DynamicArrayCreate(Chunk*);
+    ChunkIdleQueries = DynamicArrayCreate(GLuint);
+}
+
+void Chunk_DestroySharedResources() {
+    GLState_DeleteBuffers(1, &QuadIndexBuffer);
+    QuadIndexBuffer = 0;
+    QuadIndexBufferQuadCount = 0;
+
+    if (ChunkVertexArray) {
+        VertexArena_Destroy(&ChunkVertexArena);
+        UploadRing_Destroy(&ChunkUploadRing);
+        GLState_DeleteVertexArrays(1, &ChunkVertexArray);
+        GLState_DeleteBuffers(1, &ChunkDrawDataBuffer);
+        GLState_DeleteBuffers(1, &ChunkDrawCommandBuffer);
+        DynamicArrayDestroy(ChunkDrawCommands);
+        DynamicArrayDestroy(ChunkDrawDatas);
+        DynamicArrayDestroy(ChunkDrawCandidates);
+        FrustumBoxes_Destroy(&ChunkDrawBounds);
+        DynamicArrayDestroy(ChunkDrawVisible);
+        // Regions are freed along with their last member
+        ASSERT(DynamicArrayLength(ChunkRegions) == 0);
+        DynamicArrayDestroy(ChunkRegions);
+        DynamicArrayDestroy(ChunkRegionVertices);
+        DynamicArrayDestroy(ChunkSortEntries);
+        DynamicArrayDestroy(ChunkSortScratch);
+        GLState_DeleteVertexArrays(1, &ChunkOcclusionVertexArray);
+        GLState_DeleteBuffers(1, &ChunkOcclusionCornerBuffer);
+        GLState_DeleteBuffers(1, &ChunkOcclusionBoxBuffer);
+        DynamicArrayDestroy(ChunkOcclusionBoxes);
+        DynamicArrayDestroy(ChunkOcclusionTested);
+        if (DynamicArrayLength(ChunkIdleQueries) > 0) {
+            glDeleteQueries(cast(GLsizei) DynamicArrayLength(ChunkIdleQueries), ChunkIdleQueries);
+        }
+        DynamicArrayDestroy(ChunkIdleQueries);
+        ChunkVertexArray = 0;
+        ChunkDrawDataBuffer = 0;
+        ChunkDrawCommandBuffer = 0;
+        ChunkOcclusionVertexArray = 0;
+        ChunkOcclusionCornerBuffer = 0;
+        ChunkOcclusionBoxBuffer = 0;
+    }
+}
+
+void Chunk_FinishUploads() {
+    if (ChunkVertexArray) {
+        UploadRing_Fence(&ChunkUploadRing);
+        VertexArena_Fence(&ChunkVertexArena);
+    }
+}
+
+// Sizes a block of the arena for vertexCount vertices, moving it if it has to change size.
+// The block grows geometrically so a mesh that keeps getting rebuilt settles on a size it reuses,
+// and shrinks once most of it goes unused so one big mesh doesn't hold on to the space
+static void Chunk_ResizeArenaBlock(u32* offset, u32* capacity, u32 vertexCount) {
+    u32 newCapacity = *capacity;
+    if (vertexCount > newCapacity) {
+        newCapacity = newCapacity * 2 > vertexCount ? newCapacity * 2 : vertexCount;
+    } else if (vertexCount < newCapacity / 4) {
+        newCapacity = vertexCount;
+    }
+
+    if (newCapacity != *capacity) {
+        if (*capacity > 0) {
+            VertexArena_Retire(&ChunkVertexArena, *offset, *capacity);
+        }
+
+        GLuint arenaBuffer = ChunkVertexArena.Buffer;
+        *offset = newCapacity > 0 ? VertexArena_Allocate(&ChunkVertexArena, newCapacity) : 0;
+        *capacity = newCapacity;
+        if (ChunkVertexArena.Buffer != arenaBuffer) {
+            Chunk_BindVertexArena();
+        }
+    }
+}
+
+// Copies vertices into the arena at arenaOffset through the upload ring
+static void Chunk_WriteArenaVertices(u32 arenaOffset, u32 vertexCount, const Vertex* vertices) {
+    // Big writes are split up so a single one never has to wait for most of the ring
+    const u32 MaxVerticesPerWrite = cast(u32) (ChunkUploadRing.Size / 4 / sizeof(Vertex));
+
+    while (vertexCount > 0) {
+        u32 count = vertexCount < MaxVerticesPerWrite ? vertexCount : MaxVerticesPerWrite;
+        u64 ringOffset = 0;
+        void* destination = UploadRing_Allocate(&ChunkUploadRing, cast(u64) count * sizeof(Vertex), &ringOffset);
+        memcpy(destination, vertices, cast(u64) count * sizeof(Vertex));
+
+        GLState_BindBuffer(GL_COPY_READ_BUFFER, ChunkUploadRing.Buffer);
+        GLState_BindBuffer(GL_COPY_WRITE_BUFFER, ChunkVertexArena.Buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ringOffset, cast(u64) arenaOffset * sizeof(Vertex), cast(u64) count * sizeof(Vertex));
+
+        arenaOffset += count;
+        vertexCount -= count;
+        vertices += count;
+    }
+}
+
+void Chunk_Create(Chunk* chunk, s64 x, s64 y, s64 z, u32 width, u32 height, u32 depth, u32 lod, ChunkMeshMode meshMode) {
     *chunk = (Chunk){
         .Position = { x, y, z },
         .Width = width,
         .Height = height,
         .Depth = depth,
+        .Lod = lod,
         .Blocks = DynamicArrayCreate_(width * height * depth, sizeof(u16)),
-        .Vertices = DynamicArrayCreate(Vertex),
-        .Indices = DynamicArrayCreate(u32),
-        .Shader = shader,
+        .Solid = malloc((width + 2) * (height + 2) * (depth + 2)),
+        .Mesh = {
+            .Vertices = DynamicArrayCreate(Vertex),
+        },
+        .MeshMode = meshMode,
     };
 
-    glGenVertexArrays(1, &chunk->VertexArray);
-    glBindVertexArray(chunk->VertexArray);
-
-    for (u32 x = 0; x < width; x++) {
-        for (u32 y = 0; y < height; y++) {
-            for (u32 z = 0; z < depth; z++) {
-                u32 index = x + (y * width) + (z * width * height);
-                vec3 position = {
-                    cast(f32) chunk->Position.x + cast(f32) x - (cast(f32) width * 0.5f),
-                    cast(f32) chunk->Position.y + cast(f32) y - (cast(f32) height * 0.5f),
-                    cast(f32) chunk->Position.z + cast(f32) z - (cast(f32) depth * 0.5f),
-                };
-                chunk->Blocks[index] = GetBlock(position);
+    // Until the chunk has been meshed anything could be seen through it
+    memset(chunk->Mesh.FaceConnections, CHUNK_ALL_FACES, sizeof(chunk->Mesh.FaceConnections));
+    memset(chunk->FaceConnections, CHUNK_ALL_FACES, sizeof(chunk->FaceConnections));
+
+    // The packed vertices store chunk local corner positions which go up to the size of the chunk
+    ASSERT(width <= VERTEX_POSITION_MAX && height <= VERTEX_POSITION_MAX && depth <= VERTEX_POSITION_MAX);
+    // One dirty bit per slice
+    ASSERT(width <= 64 && height <= 64 && depth <= 64);
+
+    chunk->Mesh.SliceRanges = calloc(BlockFace_Count * Chunk_GetMaxSize(chunk), sizeof(ChunkSliceRange));
+
+    if (!ChunkVertexArray) {
+        Chunk_CreateSharedResources();
+    }
+
+    // No mesh can have more quads than every face of every block in the chunk
+    Chunk_ReserveQuadIndices(width * height * depth * BlockFace_Count);
+}
+
+void Chunk_Destroy(Chunk* chunk) {
+    Chunk_LeaveRegion(chunk);
+    DynamicArrayDestroy(chunk->Blocks);
+    free(chunk->Solid);
+    DynamicArrayDestroy(chunk->Mesh.Vertices);
+    free(chunk->Mesh.SliceRanges);
+    if (chunk->VertexCapacity > 0) {
+        VertexArena_Retire(&ChunkVertexArena, chunk->VertexOffset, chunk->VertexCapacity);
+    }
+    if (chunk->OcclusionQuery) {
+        if (DynamicArrayLength(ChunkIdleQueries) < ChunkMaxIdleQueries) {
+            DynamicArrayPush(ChunkIdleQueries, chunk->OcclusionQuery);
+        } else {
+            glDeleteQueries(1, &chunk->OcclusionQuery);
+        }
+    }
+}
+
+// The world space box covered by the chunk's blocks.
+// Vertex positions are relative to the -0.5 corner of the first block in the chunk and are in chunk blocks, not world blocks
+static void Chunk_GetBounds(Chunk* chunk, vec3 outMin, vec3 outMax) {
+    f32 scale = cast(f32) (1 << chunk->Lod);
+    outMin[0] = cast(f32) chunk->Position.x - (cast(f32) chunk->Width * scale * 0.5f) - 0.5f;
+    outMin[1] = cast(f32) chunk->Position.y - (cast(f32) chunk->Height * scale * 0.5f) - 0.5f;
+    outMin[2] = cast(f32) chunk->Position.z - (cast(f32) chunk->Depth * scale * 0.5f) - 0.5f;
+    outMax[0] = outMin[0] + cast(f32) chunk->Width * scale;
+    outMax[1] = outMin[1] + cast(f32) chunk->Height * scale;
+    outMax[2] = outMin[2] + cast(f32) chunk->Depth * scale;
+}
+
+// Sorts ChunkSortEntries by key with a least significant digit first radix sort, 8 bits per pass.
+// A pass where every key has the same digit is skipped, the distances only span a few exponents so that's usually the top one
+static void Chunk_SortEntries() {
+    u64 count = DynamicArrayLength(ChunkSortEntries);
+    DynamicArrayReserve(ChunkSortScratch, count);
+    DynamicArrayLength(ChunkSortScratch) = count;
+
+    for (u32 shift = 0; shift < 32; shift += 8) {
+        u64 offsets[256] = {};
+        for (u64 i = 0; i < count; i++) {
+            offsets[(ChunkSortEntries[i].Key >> shift) & 0xFF]++;
+        }
+        if (offsets[(ChunkSortEntries[0].Key >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        u64 total = 0;
+        for (u32 digit = 0; digit < 256; digit++) {
+            u64 digitCount = offsets[digit];
+            offsets[digit] = total;
+            total += digitCount;
+        }
+        for (u64 i = 0; i < count; i++) {
+            ChunkSortScratch[offsets[(ChunkSortEntries[i].Key >> shift) & 0xFF]++] = ChunkSortEntries[i];
+        }
+
+        ChunkSortEntry* sorted = ChunkSortScratch;
+        ChunkSortScratch = ChunkSortEntries;
+        ChunkSortEntries = sorted;
+    }
+}
+
+static s64 Chunk_FloorDivide(s64 a, s64 b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// The chunk's cell on the grid of chunks with its Lod, the chunk's position is the center block of that cell
+static void Chunk_GetGridPosition(Chunk* chunk, s64 outGrid[3]) {
+    const s64 position[3] = { chunk->Position.x, chunk->Position.y, chunk->Position.z };
+    const s64 size[3] = { chunk->Width, chunk->Height, chunk->Depth };
+    for (u32 axis = 0; axis < 3; axis++) {
+        s64 cellSize = size[axis] << chunk->Lod;
+        outGrid[axis] = Chunk_FloorDivide(position[axis] + size[axis] / 2 - cellSize / 2, cellSize);
+    }
+}
+
+static void ChunkRegion_MarkChanged(ChunkRegion* region) {
+    region->Built = FALSE;
+    region->ChangedFrame = ChunkDrawFrame;
+}
+
+static void ChunkRegion_GetBounds(ChunkRegion* region, vec3 outMin, vec3 outMax) {
+    f32 scale = cast(f32) (1 << region->Lod);
+    for (u32 axis = 0; axis < 3; axis++) {
+        outMin[axis] = region->Min[axis];
+        outMax[axis] = region->Min[axis] + cast(f32) (region->ChunkSize[axis] * CHUNK_REGION_SIZE) * scale;
+    }
+}
+
+// Where the member's chunk local positions start in the region's, in blocks of the Lod
+static void ChunkRegion_GetMemberOffset(ChunkRegion* region, Chunk* member, u32 outOffset[3]) {
+    s64 grid[3];
+    Chunk_GetGridPosition(member, grid);
+    for (u32 axis = 0; axis < 3; axis++) {
+        outOffset[axis] = cast(u32) (grid[axis] - region->Position[axis] * CHUNK_REGION_SIZE) * region->ChunkSize[axis];
+    }
+}
+
+static void Chunk_JoinRegion(Chunk* chunk) {
+    s64 grid[3];
+    Chunk_GetGridPosition(chunk, grid);
+    s64 regionPosition[3];
+    for (u32 axis = 0; axis < 3; axis++) {
+        regionPosition[axis] = Chunk_FloorDivide(grid[axis], CHUNK_REGION_SIZE);
+    }
+
+    // There are only a few hundred regions in view
+    ChunkRegion* region = NULL;
+    for (u64 i = 0; i < DynamicArrayLength(ChunkRegions) && !region; i++) {
+        ChunkRegion* other = ChunkRegions[i];
+        if (other->Lod == chunk->Lod && memcmp(other->Position, regionPosition, sizeof(regionPosition)) == 0) {
+            region = other;
+        }
+    }
+
+    if (!region) {
+        region = malloc(sizeof(ChunkRegion));
+        *region = (ChunkRegion){
+            .Position = { regionPosition[0], regionPosition[1], regionPosition[2] },
+            .Lod = chunk->Lod,
+            .ChunkSize = { chunk->Width, chunk->Height, chunk->Depth },
+            .Members = DynamicArrayCreate(Chunk*),
+        };
+
+        // The merged positions have to fit in the packed vertices
+        ASSERT(chunk->Width * CHUNK_REGION_SIZE <= VERTEX_POSITION_MAX && chunk->Height * CHUNK_REGION_SIZE <= VERTEX_POSITION_MAX &&
+               chunk->Depth * CHUNK_REGION_SIZE <= VERTEX_POSITION_MAX);
+
+        vec3 chunkMin, chunkMax;
+        Chunk_GetBounds(chunk, chunkMin, chunkMax);
+        u32 offset[3];
+        ChunkRegion_GetMemberOffset(region, chunk, offset);
+        for (u32 axis = 0; axis < 3; axis++) {
+            region->Min[axis] = chunkMin[axis] - cast(f32) offset[axis] * cast(f32) (1 << chunk->Lod);
+        }
+        DynamicArrayPush(ChunkRegions, region);
+    }
+
+    ASSERT(region->ChunkSize[0] == chunk->Width && region->ChunkSize[1] == chunk->Height && region->ChunkSize[2] == chunk->Depth);
+    DynamicArrayPush(region->Members, chunk);
+    chunk->Region = region;
+    ChunkRegion_MarkChanged(region);
+}
+
+void Chunk_LeaveRegion(Chunk* chunk) {
+    ChunkRegion* region = chunk->Region;
+    if (!region) {
+        return;
+    }
+    chunk->Region = NULL;
+
+    for (u64 i = 0; i < DynamicArrayLength(region->Members); i++) {
+        if (region->Members[i] == chunk) {
+            DynamicArrayPopAt(region->Members, i, NULL);
+            break;
+        }
+    }
+
+    if (DynamicArrayLength(region->Members) > 0) {
+        ChunkRegion_MarkChanged(region);
+        return;
+    }
+
+    for (u64 i = 0; i < DynamicArrayLength(ChunkRegions); i++) {
+        if (ChunkRegions[i] == region) {
+            DynamicArrayPopAt(ChunkRegions, i, NULL);
+            break;
+        }
+    }
+    if (region->VertexCapacity > 0) {
+        VertexArena_Retire(&ChunkVertexArena, region->VertexOffset, region->VertexCapacity);
+    }
+    DynamicArrayDestroy(region->Members);
+    free(region);
+}
+
+// Copies the members' meshes into the region's block of the arena one face direction at a time, so the region has
+// a face range per direction like a chunk does. Returns FALSE while a member's mesh is with a worker or not uploaded yet
+static b8 ChunkRegion_Build(ChunkRegion* region) {
+    u32 quadCount = 0;
+    for (u64 i = 0; i < DynamicArrayLength(region->Members); i++) {
+        Chunk* member = region->Members[i];
+        if (member->JobPending || member->UploadPending) {
+            return FALSE;
+        }
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            quadCount += member->FaceRanges[face].QuadCount;
+        }
+    }
+
+    DynamicArrayReserve(ChunkRegionVertices, cast(u64) quadCount * 4);
+    DynamicArrayLength(ChunkRegionVertices) = cast(u64) quadCount * 4;
+
+    u32 firstQuad = 0;
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        region->FaceRanges[face].FirstQuad = firstQuad;
+        for (u64 i = 0; i < DynamicArrayLength(region->Members); i++) {
+            Chunk* member = region->Members[i];
+
+            // The positions are packed per axis and stay below VERTEX_POSITION_MAX, so the offset is added to all three at once
+            u32 offset[3];
+            ChunkRegion_GetMemberOffset(region, member, offset);
+            u32 packedOffset = offset[0] | (offset[1] << VERTEX_POSITION_BITS) | (offset[2] << (VERTEX_POSITION_BITS * 2));
+
+            ChunkFaceRange range = member->FaceRanges[face];
+            const Vertex* source = &member->Mesh.Vertices[range.FirstQuad * 4];
+            Vertex* destination = &ChunkRegionVertices[firstQuad * 4];
+            for (u32 vertex = 0; vertex < range.QuadCount * 4; vertex++) {
+                destination[vertex] = source[vertex];
+                destination[vertex].Data0 += packedOffset;
             }
+            firstQuad += range.QuadCount;
         }
+        region->FaceRanges[face].QuadCount = firstQuad - region->FaceRanges[face].FirstQuad;
     }
 
-    Chunk_RecalculateMesh(chunk);
+    Chunk_ReserveQuadIndices(quadCount);
+    Chunk_ResizeArenaBlock(&region->VertexOffset, &region->VertexCapacity, quadCount * 4);
+    Chunk_WriteArenaVertices(region->VertexOffset, quadCount * 4, ChunkRegionVertices);
+    region->Built = TRUE;
+    return TRUE;
+}
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), cast(const void*) offsetof(Vertex, Position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), cast(const void*) offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), cast(const void*) offsetof(Vertex, TexCoord));
+// Reads the result of the chunk's last occlusion query if the GPU has it ready, otherwise the result before that is kept
+static b8 Chunk_IsOccluded(Chunk* chunk, vec3 cameraPosition) {
+    // A result from before the chunk left the frustum says nothing about where the camera is now
+    if (chunk->OcclusionFrame + 1 != ChunkDrawFrame) {
+        chunk->Occluded = FALSE;
+        chunk->OcclusionQueryPending = FALSE;
+    }
+    chunk->OcclusionFrame = ChunkDrawFrame;
+
+    if (chunk->OcclusionQueryPending) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(chunk->OcclusionQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint anySamplesPassed = GL_FALSE;
+            glGetQueryObjectuiv(chunk->OcclusionQuery, GL_QUERY_RESULT, &anySamplesPassed);
+            chunk->Occluded = !anySamplesPassed;
+            chunk->OcclusionQueryPending = FALSE;
+        }
+    }
+
+    // From inside the box every face of it faces away from the camera, so it can't be tested
+    vec3 min, max;
+    Chunk_GetBounds(chunk, min, max);
+    b8 cameraInside = TRUE;
+    for (u32 axis = 0; axis < 3; axis++) {
+        if (cameraPosition[axis] < min[axis] - ChunkOcclusionBoxPadding || cameraPosition[axis] > max[axis] + ChunkOcclusionBoxPadding) {
+            cameraInside = FALSE;
+        }
+    }
+    if (cameraInside) {
+        chunk->Occluded = FALSE;
+    }
+    return chunk->Occluded;
 }
 
-void Chunk_Destroy(Chunk* chunk) {
-    DynamicArrayDestroy(chunk->Blocks);
-    DynamicArrayDestroy(chunk->Vertices);
-    DynamicArrayDestroy(chunk->Indices);
-    glDeleteBuffers(1, &chunk->VertexBuffer);
-    glDeleteBuffers(1, &chunk->IndexBuffer);
-    glDeleteVertexArrays(1, &chunk->VertexArray);
+// Draws the boxes of the chunks in ChunkOcclusionTested against the depth of what has been drawn so far, each into the chunk's query
+static void Chunk_TestOcclusion(GLuint occlusionShader) {
+    DynamicArrayLength(ChunkOcclusionBoxes) = 0;
+    for (u64 i = 0; i < DynamicArrayLength(ChunkOcclusionTested); i++) {
+        vec3 min, max;
+        Chunk_GetBounds(ChunkOcclusionTested[i], min, max);
+        ChunkOcclusionBox box = {
+            .Min = { min[0] - ChunkOcclusionBoxPadding, min[1] - ChunkOcclusionBoxPadding, min[2] - ChunkOcclusionBoxPadding },
+            .Max = { max[0] + ChunkOcclusionBoxPadding, max[1] + ChunkOcclusionBoxPadding, max[2] + ChunkOcclusionBoxPadding },
+        };
+        DynamicArrayPush(ChunkOcclusionBoxes, box);
+    }
+
+    GLState_UseProgram(occlusionShader);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkOcclusionBoxBuffer);
+    glBufferData(GL_ARRAY_BUFFER, DynamicArraySize(ChunkOcclusionBoxes), ChunkOcclusionBoxes, GL_STREAM_DRAW);
+    GLState_BindVertexArray(ChunkOcclusionVertexArray);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer);
+
+    // The boxes only have to be depth tested
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+
+    for (u64 i = 0; i < DynamicArrayLength(ChunkOcclusionTested); i++) {
+        Chunk* chunk = ChunkOcclusionTested[i];
+        if (!chunk->OcclusionQuery) {
+            if (DynamicArrayLength(ChunkIdleQueries) > 0) {
+                DynamicArrayPop(ChunkIdleQueries, &chunk->OcclusionQuery);
+            } else {
+                glGenQueries(1, &chunk->OcclusionQuery);
+            }
+        }
+
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, chunk->OcclusionQuery);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, BlockFace_Count * 6, GL_UNSIGNED_INT, NULL, 1, cast(GLuint) i);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        chunk->OcclusionQueryPending = TRUE;
+    }
+
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 }
 
-void Chunk_Draw(Chunk* chunk, Camera* camera) {
-    mat4 modelMatrix;
-    glm_mat4_identity(modelMatrix);
+// Adds the draw commands of the face ranges of a mesh in the arena that can face the camera.
+// The mesh's vertex positions start at meshMin and it lies within meshMax, scale is the Lod's world size of a block
+static void Chunk_PushDrawCommands(const ChunkFaceRange faceRanges[BlockFace_Count], u32 vertexOffset, vec3 meshMin, vec3 meshMax, f32 scale, Camera* camera) {
+    // A face pointing in +axis can only be seen from in front of its plane, and every such plane in the mesh is above meshMin[axis],
+    // so if the camera is below that the whole direction faces away from it (and the same for -axis with meshMax)
+    b8 faceVisible[BlockFace_Count];
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        u32 axis = BlockFaces[face].Axis;
+        if (BlockFaces[face].Direction > 0) {
+            faceVisible[face] = camera->Transform.Position[axis] > meshMin[axis];
+        } else {
+            faceVisible[face] = camera->Transform.Position[axis] < meshMax[axis];
+        }
+    }
+
+    // All the commands of a mesh share its draw data
+    u32 drawDataIndex = cast(u32) DynamicArrayLength(ChunkDrawDatas);
+    b8 anyCommands = FALSE;
+
+    // The face ranges are stored back to back so neighboring visible ranges are drawn together
+    for (BlockFace face = 0; face < BlockFace_Count;) {
+        if (!faceVisible[face]) {
+            face++;
+            continue;
+        }
+
+        u32 firstQuad = faceRanges[face].FirstQuad;
+        u32 quadCount = 0;
+        for (; face < BlockFace_Count && faceVisible[face]; face++) {
+            quadCount += faceRanges[face].QuadCount;
+        }
+
+        if (quadCount > 0) {
+            DrawElementsIndirectCommand command = {
+                .Count = quadCount * 6,
+                .InstanceCount = 1,
+                .FirstIndex = firstQuad * 6,
+                .BaseVertex = cast(s32) vertexOffset,
+                .BaseInstance = drawDataIndex,
+            };
+            DynamicArrayPush(ChunkDrawCommands, command);
+            anyCommands = TRUE;
+        }
+    }
 
-    glUseProgram(chunk->Shader);
+    if (anyCommands) {
+        ChunkDrawData drawData = {
+            .Min = { meshMin[0], meshMin[1], meshMin[2] },
+            .Scale = scale,
+        };
+        DynamicArrayPush(ChunkDrawDatas, drawData);
+    }
+}
 
-    glUniformMatrix4fv(0, 1, GL_FALSE, cast(GLfloat*) modelMatrix);
+// Draws the commands pushed by Chunk_PushDrawCommands
+static void Chunk_DrawCommands(GLuint shader) {
+    GLState_UseProgram(shader);
 
-    mat4 viewMatrix;
-    Transform_ToMatrix(&camera->Transform, viewMatrix);
-    glm_mat4_inv(viewMatrix, viewMatrix);
-    glUniformMatrix4fv(1, 1, GL_FALSE, cast(GLfloat*) viewMatrix);
+    // Both buffers are respecified every frame so the driver can hand out new storage instead of waiting on the last frame
+    GLState_BindBuffer(GL_ARRAY_BUFFER, ChunkDrawDataBuffer);
+    glBufferData(GL_ARRAY_BUFFER, DynamicArraySize(ChunkDrawDatas), ChunkDrawDatas, GL_STREAM_DRAW);
+    GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, ChunkDrawCommandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, DynamicArraySize(ChunkDrawCommands), ChunkDrawCommands, GL_STREAM_DRAW);
 
-    glUniformMatrix4fv(2, 1, GL_FALSE, cast(GLfloat*) camera->ProjectionMatrix);
+    GLState_BindVertexArray(ChunkVertexArray);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer);
 
-    glBindVertexArray(chunk->VertexArray);
-    glBindBuffer(GL_ARRAY_BUFFER, chunk->VertexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk->IndexBuffer);
-    glDrawElements(GL_TRIANGLES, DynamicArrayLength(chunk->Indices), GL_UNSIGNED_INT, NULL);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, cast(GLsizei) DynamicArrayLength(ChunkDrawCommands), sizeof(DrawElementsIndirectCommand));
 }
 
-void Chunk_RecalculateMesh(Chunk* chunk) {
-    DynamicArrayLength(chunk->Vertices) = 0;
-    DynamicArrayLength(chunk->Indices) = 0;
+ChunkDrawStats Chunk_DrawChunks(Chunk** chunks, u64 chunkCount, GLuint shader, GLuint occlusionShader, Camera* camera) {
+    ChunkDrawStats stats = {};
+    if (!ChunkVertexArray) {
+        return stats;
+    }
+    ChunkDrawFrame++;
 
-    u32 currentIndex = 0;
-    for (u32 x = 0; x < chunk->Width; x++) {
+    // Far chunks stream in a few at a time, so regions are only rebuilt once they've stopped changing
+    u32 regionBuilds = 0;
+    for (u64 i = 0; i < DynamicArrayLength(ChunkRegions) && regionBuilds < ChunkRegionBuildsPerFrame; i++) {
+        ChunkRegion* region = ChunkRegions[i];
+        if (!region->Built && ChunkDrawFrame - region->ChangedFrame >= ChunkRegionSettleFrames && ChunkRegion_Build(region)) {
+            regionBuilds++;
+        }
+    }
+
+    // Most chunks are all air or all stone so they are left out before the frustum test
+    DynamicArrayLength(ChunkDrawCandidates) = 0;
+    ChunkDrawBounds.Count = 0;
+    for (u64 i = 0; i < chunkCount; i++) {
+        u32 quadCount = 0;
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            quadCount += chunks[i]->FaceRanges[face].QuadCount;
+        }
+        if (quadCount == 0) {
+            continue;
+        }
+
+        vec3 min, max;
+        Chunk_GetBounds(chunks[i], min, max);
+        FrustumBoxes_Push(&ChunkDrawBounds, min, max);
+        DynamicArrayPush(ChunkDrawCandidates, chunks[i]);
+    }
+
+    Frustum frustum;
+    Frustum_FromMatrix(&frustum, camera->ViewProjectionMatrix);
+    DynamicArrayReserve(ChunkDrawVisible, ChunkDrawBounds.Count);
+    Frustum_TestBoxes(&frustum, &ChunkDrawBounds, ChunkDrawVisible);
+
+    DynamicArrayLength(ChunkSortEntries) = 0;
+    DynamicArrayLength(ChunkOcclusionTested) = 0;
+    for (u64 i = 0; i < DynamicArrayLength(ChunkDrawCandidates); i++) {
+        if (!ChunkDrawVisible[i]) {
+            continue;
+        }
+
+        Chunk* chunk = ChunkDrawCandidates[i];
+        if (occlusionShader && Chunk_IsOccluded(chunk, camera->Transform.Position)) {
+            stats.Occluded++;
+        } else {
+            vec3 min, max, center;
+            Chunk_GetBounds(chunk, min, max);
+            glm_vec3_center(min, max, center);
+            f32 distanceSquared = glm_vec3_distance2(center, camera->Transform.Position);
+
+            ChunkSortEntry entry = { .Chunk = chunk };
+            memcpy(&entry.Key, &distanceSquared, sizeof(entry.Key));
+            DynamicArrayPush(ChunkSortEntries, entry);
+            stats.Drawn++;
+        }
+
+        // Occluded chunks are tested too so they show up again once they come into view.
+        // A chunk whose query is still in flight keeps it, queries usually take a frame or two to come back
+        if (occlusionShader && !chunk->OcclusionQueryPending) {
+            DynamicArrayPush(ChunkOcclusionTested, chunk);
+        }
+    }
+
+    DynamicArrayLength(ChunkDrawCommands) = 0;
+    DynamicArrayLength(ChunkDrawDatas) = 0;
+    if (DynamicArrayLength(ChunkSortEntries) > 0) {
+        Chunk_SortEntries();
+        for (u64 i = 0; i < DynamicArrayLength(ChunkSortEntries); i++) {
+            Chunk* chunk = ChunkSortEntries[i].Chunk;
+            ChunkRegion* region = chunk->Region;
+            vec3 min, max;
+            if (region && region->Built) {
+                // The whole region is drawn at the place of its nearest chunk that is in view
+                if (region->DrawFrame != ChunkDrawFrame) {
+                    region->DrawFrame = ChunkDrawFrame;
+                    ChunkRegion_GetBounds(region, min, max);
+                    Chunk_PushDrawCommands(region->FaceRanges, region->VertexOffset, min, max, cast(f32) (1 << region->Lod), camera);
+                }
+            } else {
+                Chunk_GetBounds(chunk, min, max);
+                Chunk_PushDrawCommands(chunk->FaceRanges, chunk->VertexOffset, min, max, cast(f32) (1 << chunk->Lod), camera);
+            }
+        }
+    }
+    stats.Commands = DynamicArrayLength(ChunkDrawCommands);
+
+    // The multi draw keeps the order of its commands
+    if (DynamicArrayLength(ChunkDrawCommands) > 0) {
+        Chunk_DrawCommands(shader);
+    }
+
+    // Testing after the terrain is drawn lets nearer chunks hide the ones behind them
+    if (DynamicArrayLength(ChunkOcclusionTested) > 0) {
+        Chunk_TestOcclusion(occlusionShader);
+    }
+    return stats;
+}
+
+static u32 CountTrailingZeros64(u64 value) {
+    return cast(u32) __builtin_ctzll(value);
+}
+
+static u16 Chunk_GetLocalBlock(Chunk* chunk, const u32 position[3]) {
+    return chunk->Blocks[position[0] + (position[1] * chunk->Width) + (position[2] * chunk->Width * chunk->Height)];
+}
+
+// A view of chunk->Solid, which is the chunk plus one block of padding on every side
+// so the meshers can look at any of the 26 blocks around a block in the chunk without bounds checks
+typedef struct ChunkSolidGrid {
+    u8* Solid;
+    s32 Strides[3];
+} ChunkSolidGrid;
+
+static ChunkSolidGrid Chunk_GetSolidGrid(Chunk* chunk) {
+    s32 paddedWidth = cast(s32) chunk->Width + 2;
+    s32 paddedHeight = cast(s32) chunk->Height + 2;
+    return (ChunkSolidGrid){
+        .Solid = chunk->Solid,
+        .Strides = { 1, paddedWidth, paddedWidth * paddedHeight },
+    };
+}
+
+static s32 ChunkSolidGrid_Index(const ChunkSolidGrid* grid, s32 x, s32 y, s32 z) {
+    return (x + 1) * grid->Strides[0] + (y + 1) * grid->Strides[1] + (z + 1) * grid->Strides[2];
+}
+
+static s32 ChunkSolidGrid_LocalIndex(const ChunkSolidGrid* grid, const u32 position[3]) {
+    return ChunkSolidGrid_Index(grid, cast(s32) position[0], cast(s32) position[1], cast(s32) position[2]);
+}
+
+// Whether a padding block is across one of the chunk's LodSeams, those are always air
+static b8 Chunk_IsAcrossLodSeam(Chunk* chunk, s32 x, s32 y, s32 z) {
+    u8 seams = chunk->LodSeams;
+    return ((seams & (1 << BlockFace_Left)) && x < 0) || ((seams & (1 << BlockFace_Right)) && x >= cast(s32) chunk->Width) ||
+           ((seams & (1 << BlockFace_Bottom)) && y < 0) || ((seams & (1 << BlockFace_Top)) && y >= cast(s32) chunk->Height) ||
+           ((seams & (1 << BlockFace_Back)) && z < 0) || ((seams & (1 << BlockFace_Front)) && z >= cast(s32) chunk->Depth);
+}
+
+static void Chunk_FillSolidGrid(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    u8* solid = chunk->Solid;
+    for (s32 z = -1; z <= cast(s32) chunk->Depth; z++) {
+        for (s32 y = -1; y <= cast(s32) chunk->Height; y++) {
+            for (s32 x = -1; x <= cast(s32) chunk->Width; x++) {
+                *solid++ = !Chunk_IsAcrossLodSeam(chunk, x, y, z) && Chunk_GetNeighborBlock(chunk, neighbors, x, y, z) != BlockID_Air;
+            }
+        }
+    }
+}
+
+// Returns the ambient occlusion of the 4 corners of a block face, 2 bits per corner in BlockFaceInfo corner order.
+// Each corner looks at the two blocks beside it and the one diagonal to it in the layer in front of the face
+static u8 Chunk_GetFaceAO(const ChunkSolidGrid* grid, BlockFace face, const u32 position[3]) {
+    const BlockFaceInfo* info = &BlockFaces[face];
+    u32 axis = info->Axis;
+    u32 uAxis = axis == 0 ? 1 : 0;
+    u32 vAxis = axis == 2 ? 1 : 2;
+
+    const u8* front = &grid->Solid[ChunkSolidGrid_LocalIndex(grid, position) + info->Direction * grid->Strides[axis]];
+
+    u8 ao = 0;
+    for (u32 i = 0; i < 4; i++) {
+        s32 uOffset = info->Corners[i][uAxis] ? grid->Strides[uAxis] : -grid->Strides[uAxis];
+        s32 vOffset = info->Corners[i][vAxis] ? grid->Strides[vAxis] : -grid->Strides[vAxis];
+
+        u32 side1 = front[uOffset];
+        u32 side2 = front[vOffset];
+        u32 corner = front[uOffset + vOffset];
+        // With both sides solid the corner block can't be seen, so it's fully occluded whatever it is
+        u32 occlusion = (side1 && side2) ? 0 : 3 - (side1 + side2 + corner);
+        ao |= occlusion << (i * 2);
+    }
+    return ao;
+}
+
+#define CHUNK_FACE_AO(ao, corner) (((ao) >> ((corner) * 2)) & 3)
+
+// A quad covering Size[axis] blocks along each axis starting at the block at local position Start
+typedef struct ChunkQuad {
+    u8 Face;
+    u8 AO;
+    u8 Start[3];
+    u8 Size[3];
+} ChunkQuad;
+
+// Writes the 4 vertices of a quad, the caller has already made room for them
+static void Chunk_WriteQuad(Chunk* chunk, Vertex* vertices, BlockFace face, const u32 start[3], const u32 size[3], u8 ao) {
+    const BlockFaceInfo* info = &BlockFaces[face];
+    u16 block = Chunk_GetLocalBlock(chunk, start);
+
+    // The shared indices split every quad along the corner 0 to 2 diagonal, the occlusion is interpolated
+    // differently depending on the diagonal so rotate the corners to split along the brighter one instead.
+    // Rotating keeps the winding the same
+    u32 firstCorner = 0;
+    if (CHUNK_FACE_AO(ao, 0) + CHUNK_FACE_AO(ao, 2) < CHUNK_FACE_AO(ao, 1) + CHUNK_FACE_AO(ao, 3)) {
+        firstCorner = 1;
+    }
+
+    for (u32 i = 0; i < 4; i++) {
+        u32 corner = (i + firstCorner) % 4;
+        u32 position[3];
+        for (u32 axis = 0; axis < 3; axis++) {
+            position[axis] = start[axis] + info->Corners[corner][axis] * size[axis];
+        }
+        u32 u = info->TexCoords[corner][0] * size[info->TexCoordAxes[0]];
+        u32 v = info->TexCoords[corner][1] * size[info->TexCoordAxes[1]];
+        vertices[i] = Vertex_Pack(position[0], position[1], position[2], face, u, v, CHUNK_FACE_AO(ao, corner), block);
+    }
+}
+
+// Sizes the vertex array for exactly quadCount quads and returns it, this is the only allocation the meshers make for their output
+static Vertex* Chunk_ResizeVertices(Chunk* chunk, u32 quadCount) {
+    DynamicArrayReserve(chunk->Mesh.Vertices, quadCount * 4);
+    DynamicArrayLength(chunk->Mesh.Vertices) = quadCount * 4;
+    return chunk->Mesh.Vertices;
+}
+
+static ChunkSliceRange* Chunk_GetSliceRange(Chunk* chunk, BlockFace face, u32 slice) {
+    return &chunk->Mesh.SliceRanges[face * Chunk_GetMaxSize(chunk) + slice];
+}
+
+static u32 Chunk_GetSliceCount(Chunk* chunk, BlockFace face) {
+    const u32 chunkSize[3] = { chunk->Width, chunk->Height, chunk->Depth };
+    return chunkSize[BlockFaces[face].Axis];
+}
+
+// The meshers write the quads of each direction one after another in BlockFace order and the quads of each direction in slice order.
+// sliceQuadCounts is indexed the same as SliceRanges, a freshly generated mesh has no spare capacity
+static void Chunk_SetSliceRanges(Chunk* chunk, const u32* sliceQuadCounts) {
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+    u32 firstQuad = 0;
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        chunk->Mesh.FaceRanges[face].FirstQuad = firstQuad;
+        for (u32 slice = 0; slice < Chunk_GetSliceCount(chunk, face); slice++) {
+            u32 quadCount = sliceQuadCounts[face * maxSize + slice];
+            *Chunk_GetSliceRange(chunk, face, slice) = (ChunkSliceRange){
+                .FirstQuad = firstQuad,
+                .QuadCount = quadCount,
+                .Capacity = quadCount,
+            };
+            firstQuad += quadCount;
+        }
+        chunk->Mesh.FaceRanges[face].QuadCount = firstQuad - chunk->Mesh.FaceRanges[face].FirstQuad;
+    }
+}
+
+
+// sliceQuadCounts gets the number of visible faces in each slice of each direction, indexed the same as SliceRanges
+static u32 Chunk_FindVisibleFaces(Chunk* chunk, const ChunkSolidGrid* grid, u8* visibleFaces, u32* sliceQuadCounts) {
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+    s32 neighborOffsets[BlockFace_Count];
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        neighborOffsets[face] = BlockFaces[face].Direction * grid->Strides[BlockFaces[face].Axis];
+    }
+
+    u32 count = 0;
+    for (u32 z = 0; z < chunk->Depth; z++) {
         for (u32 y = 0; y < chunk->Height; y++) {
-            for (u32 z = 0; z < chunk->Depth; z++) {
+            for (u32 x = 0; x < chunk->Width; x++) {
                 u32 index = x + (y * chunk->Width) + (z * chunk->Width * chunk->Height);
-                vec3 position = {
-                    cast(f32) chunk->Position.x + cast(f32) x - (cast(f32) chunk->Width * 0.5f),
-                    cast(f32) chunk->Position.y + cast(f32) y - (cast(f32) chunk->Height * 0.5f),
-                    cast(f32) chunk->Position.z + cast(f32) z - (cast(f32) chunk->Depth * 0.5f),
-                };
-
+                visibleFaces[index] = 0;
                 if (chunk->Blocks[index] == BlockID_Air) {
                     continue;
                 }
 
-                // Top
-                if (GetBlock((vec3){ position[0], position[1] + 1, position[2] }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                            0.0f,
-                            1.0f,
-                            0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                            0.0f,
-                            1.0f,
-                            0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                            0.0f,
-                            1.0f,
-                            0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                            0.0f,
-                            1.0f,
-                            0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-
-                    currentIndex += 4;
+                const u32 position[3] = { x, y, z };
+                const u8* solid = &grid->Solid[ChunkSolidGrid_LocalIndex(grid, position)];
+                for (BlockFace face = 0; face < BlockFace_Count; face++) {
+                    if (!solid[neighborOffsets[face]]) {
+                        visibleFaces[index] |= 1 << face;
+                        sliceQuadCounts[face * maxSize + position[BlockFaces[face].Axis]]++;
+                        count++;
+                    }
                 }
+            }
+        }
+    }
+    return count;
+}
 
-                // Bottom
-                if (GetBlock((vec3){ position[0], position[1] - 1, position[2] }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                            -1.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                            -1.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                            -1.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                            -1.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    currentIndex += 4;
+// The reference mesher, every visible block face becomes its own quad
+static void Chunk_GeneratePerFaceMesh(Chunk* chunk) {
+    ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+
+    u8* visibleFaces = malloc(chunk->Width * chunk->Height * chunk->Depth);
+    u32* sliceQuadCounts = calloc(BlockFace_Count * maxSize, sizeof(u32));
+    u32 quadCount = Chunk_FindVisibleFaces(chunk, &grid, visibleFaces, sliceQuadCounts);
+    Chunk_SetSliceRanges(chunk, sliceQuadCounts);
+
+    // Reuses the counts as the number of quads written to each slice so far
+    memset(sliceQuadCounts, 0, BlockFace_Count * maxSize * sizeof(u32));
+    Vertex* vertices = Chunk_ResizeVertices(chunk, quadCount);
+
+    for (u32 z = 0; z < chunk->Depth; z++) {
+        for (u32 y = 0; y < chunk->Height; y++) {
+            for (u32 x = 0; x < chunk->Width; x++) {
+                u32 index = x + (y * chunk->Width) + (z * chunk->Width * chunk->Height);
+                u32 faces = visibleFaces[index];
+                while (faces) {
+                    BlockFace face = CountTrailingZeros64(faces);
+                    faces &= faces - 1;
+
+                    const u32 start[3] = { x, y, z };
+                    const u32 size[3] = { 1, 1, 1 };
+                    u32 slice = start[BlockFaces[face].Axis];
+                    u32 quad = Chunk_GetSliceRange(chunk, face, slice)->FirstQuad + sliceQuadCounts[face * maxSize + slice]++;
+                    Chunk_WriteQuad(chunk, &vertices[quad * 4], face, start, size, Chunk_GetFaceAO(&grid, face, start));
                 }
+            }
+        }
+    }
+
+    free(sliceQuadCounts);
+    free(visibleFaces);
+}
+
+// A merged quad interpolates the occlusion of its own 4 corners across all of the faces in it, which is only right along
+// an axis that the occlusion doesn't change along, e.g. faces along the bottom of a wall can be merged along the wall
+static void Chunk_GetFaceAOMergeAxes(BlockFace face, u8 ao, b8* outMergeU, b8* outMergeV) {
+    const BlockFaceInfo* info = &BlockFaces[face];
+    u32 axis = info->Axis;
+    u32 uAxis = axis == 0 ? 1 : 0;
+    u32 vAxis = axis == 2 ? 1 : 2;
+
+    *outMergeU = TRUE;
+    *outMergeV = TRUE;
+    for (u32 i = 0; i < 4; i++) {
+        for (u32 j = i + 1; j < 4; j++) {
+            if (CHUNK_FACE_AO(ao, i) == CHUNK_FACE_AO(ao, j)) {
+                continue;
+            }
+            if (info->Corners[i][vAxis] == info->Corners[j][vAxis]) {
+                *outMergeU = FALSE;
+            }
+            if (info->Corners[i][uAxis] == info->Corners[j][uAxis]) {
+                *outMergeV = FALSE;
+            }
+        }
+    }
+}
+
+static b8 Chunk_CanMergeFace(Chunk* chunk, const ChunkSolidGrid* grid, BlockFace face, const u32 position[3], u16 block, u8 ao) {
+    return Chunk_GetLocalBlock(chunk, position) == block && Chunk_GetFaceAO(grid, face, position) == ao;
+}
 
-                // Left
-                if (GetBlock((vec3){ position[0] - 1, position[1], position[2] }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                            -1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                            -1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                            -1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                            -1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    currentIndex += 4;
+// Greedily merges the visible faces of one slice, first along each row and then across rows.
+// rows[v] has bit u set when the face at (u, v) in the slice is visible, they are cleared as the faces get used.
+// Returns the number of quads written to outQuads
+static u32 Chunk_MergeSliceFaces(Chunk* chunk, const ChunkSolidGrid* grid, BlockFace face, u32 slice, u64* rows, ChunkQuad* outQuads) {
+    const u32 chunkSize[3] = { chunk->Width, chunk->Height, chunk->Depth };
+    u32 axis = BlockFaces[face].Axis;
+    u32 uAxis = axis == 0 ? 1 : 0;
+    u32 vAxis = axis == 2 ? 1 : 2;
+
+    u32 quadCount = 0;
+    for (u32 v = 0; v < chunkSize[vAxis]; v++) {
+        while (rows[v]) {
+            u64 row = rows[v];
+
+            u32 start[3];
+            start[axis] = slice;
+            start[uAxis] = CountTrailingZeros64(row);
+            start[vAxis] = v;
+            u16 block = Chunk_GetLocalBlock(chunk, start);
+            u8 ao = Chunk_GetFaceAO(grid, face, start);
+
+            b8 mergeU, mergeV;
+            Chunk_GetFaceAOMergeAxes(face, ao, &mergeU, &mergeV);
+
+            u32 width = mergeU ? CountTrailingZeros64(~(row >> start[uAxis])) : 1;
+            for (u32 i = 1; i < width; i++) {
+                u32 position[3] = { start[0], start[1], start[2] };
+                position[uAxis] += i;
+                if (!Chunk_CanMergeFace(chunk, grid, face, position, block, ao)) {
+                    width = i;
+                    break;
+                }
+            }
+
+            u64 runMask = ((1ull << width) - 1) << start[uAxis];
+            rows[v] &= ~runMask;
+
+            u32 height = 1;
+            for (; mergeV && v + height < chunkSize[vAxis]; height++) {
+                if ((rows[v + height] & runMask) != runMask) {
+                    break;
                 }
 
-                // Right
-                if (GetBlock((vec3){ position[0] + 1, position[1], position[2] }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             1.0f,
-                             0.0f,
-                             0.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-
-                    currentIndex += 4;
+                b8 canMerge = TRUE;
+                for (u32 i = 0; i < width; i++) {
+                    u32 position[3] = { start[0], start[1], start[2] };
+                    position[uAxis] += i;
+                    position[vAxis] += height;
+                    if (!Chunk_CanMergeFace(chunk, grid, face, position, block, ao)) {
+                        canMerge = FALSE;
+                        break;
+                    }
+                }
+                if (!canMerge) {
+                    break;
                 }
 
-                // Front
-                if (GetBlock((vec3){ position[0], position[1], position[2] + 1 }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                             1.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                             1.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                             1.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                             0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                             1.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-
-                    currentIndex += 4;
+                rows[v + height] &= ~runMask;
+            }
+
+            ChunkQuad* quad = &outQuads[quadCount++];
+            quad->Face = face;
+            quad->AO = ao;
+            for (u32 i = 0; i < 3; i++) {
+                quad->Start[i] = start[i];
+            }
+            quad->Size[axis] = 1;
+            quad->Size[uAxis] = width;
+            quad->Size[vAxis] = height;
+        }
+    }
+    return quadCount;
+}
+
+// Merges coplanar faces with the same block id and ambient occlusion into larger quads.
+// For each axis the solid blocks of every column along that axis are packed into a bitmask (with one block of padding
+// from the neighbors on each end) so the visible faces of a whole column fall out of a shift and a mask.
+// The visible faces are then scattered into one row mask per slice and merged by Chunk_MergeSliceFaces.
+// Returns the number of quads written to outQuads in BlockFace and then slice order, which the caller must free.
+static u32 Chunk_FindGreedyQuads(Chunk* chunk, const ChunkSolidGrid* grid, ChunkQuad** outQuads) {
+    const u32 chunkSize[3] = { chunk->Width, chunk->Height, chunk->Depth };
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+    for (u32 axis = 0; axis < 3; axis++) {
+        // The padding needs two extra bits in each column
+        ASSERT(chunkSize[axis] + 2 <= 64);
+    }
+
+    // Indexed by [face][slice][row], bit n of a row is set if the face at column n is visible
+    u64* faceMasks = calloc(BlockFace_Count * maxSize * maxSize, sizeof(u64));
+    #define FACE_MASK(face, slice, row) faceMasks[((face) * maxSize + (slice)) * maxSize + (row)]
+
+    // Merging can only reduce the number of quads so the visible face count bounds the quad count
+    u32 visibleFaceCount = 0;
+    for (u32 axis = 0; axis < 3; axis++) {
+        u32 uAxis = axis == 0 ? 1 : 0;
+        u32 vAxis = axis == 2 ? 1 : 2;
+
+        BlockFace positiveFace = axis == 0 ? BlockFace_Right : (axis == 1 ? BlockFace_Top : BlockFace_Front);
+        BlockFace negativeFace = axis == 0 ? BlockFace_Left : (axis == 1 ? BlockFace_Bottom : BlockFace_Back);
+
+        for (u32 v = 0; v < chunkSize[vAxis]; v++) {
+            for (u32 u = 0; u < chunkSize[uAxis]; u++) {
+                u32 position[3];
+                position[axis] = 0;
+                position[uAxis] = u;
+                position[vAxis] = v;
+
+                // Starts at the padding before the first block in the column
+                const u8* solid = &grid->Solid[ChunkSolidGrid_LocalIndex(grid, position) - grid->Strides[axis]];
+                u64 column = 0;
+                for (u32 i = 0; i < chunkSize[axis] + 2; i++, solid += grid->Strides[axis]) {
+                    column |= cast(u64) *solid << i;
                 }
 
-                // Back
-                if (GetBlock((vec3){ position[0], position[1], position[2] - 1 }) == BlockID_Air) {
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                            -1.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                             0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                            -1.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            1.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                             0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                            -1.0f,
-                        },
-                        .TexCoord = {
-                            1.0f,
-                            0.0f,
-                        },
-                    }));
-                    DynamicArrayPush(chunk->Vertices, ((Vertex){
-                        .Position = {
-                            -0.5f + position[0],
-                            -0.5f + position[1],
-                            -0.5f + position[2],
-                        },
-                        .Normal = {
-                             0.0f,
-                             0.0f,
-                            -1.0f,
-                        },
-                        .TexCoord = {
-                            0.0f,
-                            0.0f,
-                        },
-                    }));
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 1);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-
-                    DynamicArrayPush(chunk->Indices, currentIndex + 0);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 2);
-                    DynamicArrayPush(chunk->Indices, currentIndex + 3);
-
-                    currentIndex += 4;
+                u64 inside = ((1ull << chunkSize[axis]) - 1) << 1;
+                u64 positive = (column & ~(column >> 1)) & inside;
+                u64 negative = (column & ~(column << 1)) & inside;
+
+                while (positive) {
+                    u32 slice = CountTrailingZeros64(positive) - 1;
+                    FACE_MASK(positiveFace, slice, v) |= 1ull << u;
+                    positive &= positive - 1;
+                    visibleFaceCount++;
+                }
+                while (negative) {
+                    u32 slice = CountTrailingZeros64(negative) - 1;
+                    FACE_MASK(negativeFace, slice, v) |= 1ull << u;
+                    negative &= negative - 1;
+                    visibleFaceCount++;
                 }
             }
         }
     }
 
-    glGenBuffers(1, &chunk->VertexBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, chunk->VertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, DynamicArraySize(chunk->Vertices), chunk->Vertices, GL_STATIC_DRAW);
+    ChunkQuad* quads = malloc(visibleFaceCount * sizeof(ChunkQuad));
+    u32 quadCount = 0;
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        for (u32 slice = 0; slice < chunkSize[BlockFaces[face].Axis]; slice++) {
+            quadCount += Chunk_MergeSliceFaces(chunk, grid, face, slice, &FACE_MASK(face, slice, 0), &quads[quadCount]);
+        }
+    }
+
+    #undef FACE_MASK
+    free(faceMasks);
+
+    *outQuads = quads;
+    return quadCount;
+}
+
+static void Chunk_GenerateGreedyMesh(Chunk* chunk) {
+    ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+
+    ChunkQuad* quads = NULL;
+    u32 quadCount = Chunk_FindGreedyQuads(chunk, &grid, &quads);
+
+    u32* sliceQuadCounts = calloc(BlockFace_Count * maxSize, sizeof(u32));
+    Vertex* vertices = Chunk_ResizeVertices(chunk, quadCount);
+    for (u32 i = 0; i < quadCount; i++) {
+        const u32 start[3] = { quads[i].Start[0], quads[i].Start[1], quads[i].Start[2] };
+        const u32 size[3] = { quads[i].Size[0], quads[i].Size[1], quads[i].Size[2] };
+        Chunk_WriteQuad(chunk, &vertices[i * 4], quads[i].Face, start, size, quads[i].AO);
+        sliceQuadCounts[quads[i].Face * maxSize + start[BlockFaces[quads[i].Face].Axis]]++;
+    }
+    Chunk_SetSliceRanges(chunk, sliceQuadCounts);
+
+    free(sliceQuadCounts);
+    free(quads);
+}
+
+// Flood fills the air in the chunk and connects every pair of faces that the same pocket of air touches
+static void Chunk_FindFaceConnections(Chunk* chunk, u8 outConnections[BlockFace_Count]) {
+    const s32 size[3] = { cast(s32) chunk->Width, cast(s32) chunk->Height, cast(s32) chunk->Depth };
+    const s32 strides[3] = { 1, size[0], size[0] * size[1] };
+    // The face on the low and high side of each axis
+    const BlockFace axisFaces[3][2] = {
+        { BlockFace_Left, BlockFace_Right },
+        { BlockFace_Bottom, BlockFace_Top },
+        { BlockFace_Back, BlockFace_Front },
+    };
+
+    memset(outConnections, 0, BlockFace_Count * sizeof(u8));
+
+    // Most chunks are all stone or all air, neither needs the flood fill
+    u32 blockCount = chunk->Width * chunk->Height * chunk->Depth;
+    u32 airCount = 0;
+    for (u32 i = 0; i < blockCount; i++) {
+        airCount += chunk->Blocks[i] == BlockID_Air;
+    }
+    if (airCount == 0) {
+        return;
+    }
+    if (airCount == blockCount) {
+        memset(outConnections, CHUNK_ALL_FACES, BlockFace_Count * sizeof(u8));
+        return;
+    }
+
+    b8* visited = calloc(blockCount, sizeof(b8));
+    // Positions packed 8 bits per axis
+    u32* stack = malloc(airCount * sizeof(u32));
+
+    u32 start = 0;
+    for (s32 z = 0; z < size[2]; z++) {
+        for (s32 y = 0; y < size[1]; y++) {
+            for (s32 x = 0; x < size[0]; x++, start++) {
+                if (visited[start] || chunk->Blocks[start] != BlockID_Air) {
+                    continue;
+                }
+
+                u8 touchedFaces = 0;
+                u32 stackCount = 0;
+                stack[stackCount++] = cast(u32) (x | (y << 8) | (z << 16));
+                visited[start] = TRUE;
+                while (stackCount > 0) {
+                    u32 packed = stack[--stackCount];
+                    const s32 position[3] = { cast(s32) (packed & 0xFF), cast(s32) ((packed >> 8) & 0xFF), cast(s32) (packed >> 16) };
+                    s32 index = position[0] + position[1] * strides[1] + position[2] * strides[2];
+
+                    for (u32 axis = 0; axis < 3; axis++) {
+                        for (s32 side = 0; side < 2; side++) {
+                            s32 neighbor = position[axis] + (side ? 1 : -1);
+                            if (neighbor < 0 || neighbor >= size[axis]) {
+                                touchedFaces |= 1 << axisFaces[axis][side];
+                                continue;
+                            }
+
+                            s32 neighborIndex = index + (side ? strides[axis] : -strides[axis]);
+                            if (!visited[neighborIndex] && chunk->Blocks[neighborIndex] == BlockID_Air) {
+                                visited[neighborIndex] = TRUE;
+                                stack[stackCount++] = packed + (side ? 1u : cast(u32) -1) * (1u << (axis * 8));
+                            }
+                        }
+                    }
+                }
+
+                for (BlockFace face = 0; face < BlockFace_Count; face++) {
+                    if (touchedFaces & (1 << face)) {
+                        outConnections[face] |= touchedFaces;
+                    }
+                }
+            }
+        }
+    }
+
+    free(stack);
+    free(visited);
+}
+
+void Chunk_GenerateMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    Chunk_FillSolidGrid(chunk, neighbors);
+    memset(chunk->DirtySlices, 0, sizeof(chunk->DirtySlices));
+    chunk->ConnectionsDirty = FALSE;
+    Chunk_FindFaceConnections(chunk, chunk->Mesh.FaceConnections);
+
+    switch (chunk->MeshMode) {
+        case ChunkMeshMode_PerFace: {
+            Chunk_GeneratePerFaceMesh(chunk);
+        } break;
+
+        case ChunkMeshMode_Greedy: {
+            Chunk_GenerateGreedyMesh(chunk);
+        } break;
+
+        default: {
+            ASSERT(FALSE);
+        } break;
+    }
+}
+
+void Chunk_UploadMesh(Chunk* chunk) {
+    // Slices that were given room to grow can take the mesh past the largest mesh Chunk_Create reserved for
+    Chunk_ReserveQuadIndices(cast(u32) (DynamicArrayLength(chunk->Mesh.Vertices) / 4));
+
+    u32 vertexCount = cast(u32) DynamicArrayLength(chunk->Mesh.Vertices);
+    Chunk_ResizeArenaBlock(&chunk->VertexOffset, &chunk->VertexCapacity, vertexCount);
+    Chunk_WriteArenaVertices(chunk->VertexOffset, vertexCount, chunk->Mesh.Vertices);
+
+    memcpy(chunk->FaceRanges, chunk->Mesh.FaceRanges, sizeof(chunk->FaceRanges));
+    memcpy(chunk->FaceConnections, chunk->Mesh.FaceConnections, sizeof(chunk->FaceConnections));
+
+    if (chunk->Region) {
+        ChunkRegion_MarkChanged(chunk->Region);
+    } else if (chunk->Lod >= CHUNK_REGION_MIN_LOD) {
+        Chunk_JoinRegion(chunk);
+    }
+}
+
+void Chunk_RecalculateMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    Chunk_GenerateMesh(chunk, neighbors);
+    Chunk_UploadMesh(chunk);
+}
+
+// Whether the air blocks next to the block are connected to each other inside the 3x3x3 blocks around it without going through it.
+// If they are, turning the block into air or out of it can't join or split any pocket of air
+static b8 Chunk_IsLocallyConnected(Chunk* chunk, const s32 position[3]) {
+    const s32 chunkSize[3] = { cast(s32) chunk->Width, cast(s32) chunk->Height, cast(s32) chunk->Depth };
+
+    // Which of the 3x3x3 blocks are air, the center and blocks outside the chunk aren't
+    b8 air[27] = {};
+    u32 start = 27;
+    for (s32 i = 0; i < 27; i++) {
+        const s32 offset[3] = { i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1 };
+        const s32 block[3] = { position[0] + offset[0], position[1] + offset[1], position[2] + offset[2] };
+        if (i == 13 || block[0] < 0 || block[0] >= chunkSize[0] || block[1] < 0 || block[1] >= chunkSize[1] || block[2] < 0 || block[2] >= chunkSize[2]) {
+            continue;
+        }
+        air[i] = chunk->Blocks[block[0] + (block[1] * chunkSize[0]) + (block[2] * chunkSize[0] * chunkSize[1])] == BlockID_Air;
+        if (air[i] && abs(offset[0]) + abs(offset[1]) + abs(offset[2]) == 1) {
+            start = i;
+        }
+    }
+    if (start == 27) {
+        return TRUE; // No air next to the block
+    }
+
+    const s32 strides[3] = { 1, 3, 9 };
+    b8 visited[27] = {};
+    u32 stack[27];
+    u32 stackCount = 0;
+    stack[stackCount++] = start;
+    visited[start] = TRUE;
+    while (stackCount > 0) {
+        s32 index = stack[--stackCount];
+        const s32 local[3] = { index % 3, (index / 3) % 3, index / 9 };
+        for (u32 axis = 0; axis < 3; axis++) {
+            for (s32 side = -1; side <= 1; side += 2) {
+                if (local[axis] + side < 0 || local[axis] + side > 2) {
+                    continue;
+                }
+                s32 neighbor = index + side * strides[axis];
+                if (air[neighbor] && !visited[neighbor]) {
+                    visited[neighbor] = TRUE;
+                    stack[stackCount++] = neighbor;
+                }
+            }
+        }
+    }
+
+    for (u32 axis = 0; axis < 3; axis++) {
+        if (air[13 - strides[axis]] && !visited[13 - strides[axis]]) {
+            return FALSE;
+        }
+        if (air[13 + strides[axis]] && !visited[13 + strides[axis]]) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Works out how a block inside the chunk turning into air or out of it changes the face connections,
+// only the edits it can't work out locally need the whole chunk flood filled again
+static void Chunk_UpdateFaceConnections(Chunk* chunk, const s32 position[3], b8 becameAir) {
+    const s32 chunkSize[3] = { cast(s32) chunk->Width, cast(s32) chunk->Height, cast(s32) chunk->Depth };
+
+    u8 touchedFaces = 0;
+    b8 airNeighbor = FALSE;
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        s32 neighbor[3] = { position[0], position[1], position[2] };
+        neighbor[BlockFaces[face].Axis] += BlockFaces[face].Direction;
+        if (neighbor[BlockFaces[face].Axis] < 0 || neighbor[BlockFaces[face].Axis] >= chunkSize[BlockFaces[face].Axis]) {
+            touchedFaces |= 1 << face;
+        } else if (chunk->Blocks[neighbor[0] + (neighbor[1] * chunkSize[0]) + (neighbor[2] * chunkSize[0] * chunkSize[1])] == BlockID_Air) {
+            airNeighbor = TRUE;
+        }
+    }
+
+    // Away from the chunk's faces the block can only matter by joining or splitting pockets of air
+    if (touchedFaces == 0 && Chunk_IsLocallyConnected(chunk, position)) {
+        return;
+    }
+
+    // A new pocket of a single block only connects the faces it's on
+    if (becameAir && !airNeighbor) {
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            if (touchedFaces & (1 << face)) {
+                chunk->Mesh.FaceConnections[face] |= touchedFaces;
+            }
+        }
+        return;
+    }
+
+    chunk->ConnectionsDirty = TRUE;
+}
+
+void Chunk_SetBlock(Chunk* chunk, s32 x, s32 y, s32 z, u16 block) {
+    ASSERT(!chunk->JobPending && chunk->References == 0);
+    ASSERT(x >= -1 && x <= cast(s32) chunk->Width && y >= -1 && y <= cast(s32) chunk->Height && z >= -1 && z <= cast(s32) chunk->Depth);
+
+    const s32 position[3] = { x, y, z };
+    const s32 chunkSize[3] = { cast(s32) chunk->Width, cast(s32) chunk->Height, cast(s32) chunk->Depth };
+
+    // Blocks of the padding belong to the neighbor, they don't change this chunk's connections
+    if (x >= 0 && x < chunkSize[0] && y >= 0 && y < chunkSize[1] && z >= 0 && z < chunkSize[2]) {
+        u16* target = &chunk->Blocks[x + (y * chunkSize[0]) + (z * chunkSize[0] * chunkSize[1])];
+        b8 wasAir = *target == BlockID_Air;
+        *target = block;
+        if (wasAir != (block == BlockID_Air)) {
+            Chunk_UpdateFaceConnections(chunk, position, !wasAir);
+        }
+    }
+
+    if (!Chunk_IsAcrossLodSeam(chunk, x, y, z)) {
+        ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+        grid.Solid[ChunkSolidGrid_Index(&grid, x, y, z)] = block != BlockID_Air;
+    }
+
+    // A face depends on its own block and on the layer of blocks in front of it (for culling and ambient occlusion),
+    // so the block changes the faces in its own slice and in the slice behind it, and greedy merging can change the rest of those slices
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        u32 axis = BlockFaces[face].Axis;
+        const s32 slices[2] = { position[axis], position[axis] - BlockFaces[face].Direction };
+        for (u32 i = 0; i < 2; i++) {
+            if (slices[i] >= 0 && slices[i] < chunkSize[axis]) {
+                chunk->DirtySlices[face] |= 1ull << slices[i];
+            }
+        }
+    }
+}
+
+// Finds the quads of one slice with the chunk's mesh mode and returns how many were written to outQuads,
+// which needs room for a quad per block in the slice
+static u32 Chunk_FindSliceQuads(Chunk* chunk, const ChunkSolidGrid* grid, BlockFace face, u32 slice, ChunkQuad* outQuads) {
+    const u32 chunkSize[3] = { chunk->Width, chunk->Height, chunk->Depth };
+    u32 axis = BlockFaces[face].Axis;
+    u32 uAxis = axis == 0 ? 1 : 0;
+    u32 vAxis = axis == 2 ? 1 : 2;
+    s32 frontOffset = BlockFaces[face].Direction * grid->Strides[axis];
+
+    u64 rows[64] = {};
+    for (u32 v = 0; v < chunkSize[vAxis]; v++) {
+        for (u32 u = 0; u < chunkSize[uAxis]; u++) {
+            u32 position[3];
+            position[axis] = slice;
+            position[uAxis] = u;
+            position[vAxis] = v;
+
+            const u8* solid = &grid->Solid[ChunkSolidGrid_LocalIndex(grid, position)];
+            if (*solid && !solid[frontOffset]) {
+                rows[v] |= 1ull << u;
+            }
+        }
+    }
+
+    if (chunk->MeshMode == ChunkMeshMode_Greedy) {
+        return Chunk_MergeSliceFaces(chunk, grid, face, slice, rows, outQuads);
+    }
+
+    u32 quadCount = 0;
+    for (u32 v = 0; v < chunkSize[vAxis]; v++) {
+        while (rows[v]) {
+            ChunkQuad* quad = &outQuads[quadCount++];
+            quad->Face = face;
+            quad->Start[axis] = slice;
+            quad->Start[uAxis] = CountTrailingZeros64(rows[v]);
+            quad->Start[vAxis] = v;
+            quad->Size[0] = quad->Size[1] = quad->Size[2] = 1;
+            rows[v] &= rows[v] - 1;
+
+            const u32 start[3] = { quad->Start[0], quad->Start[1], quad->Start[2] };
+            quad->AO = Chunk_GetFaceAO(grid, face, start);
+        }
+    }
+    return quadCount;
+}
+
+// Writes the quads of a slice into its range, padding the rest of its capacity with degenerate quads
+static void Chunk_WriteSlice(Chunk* chunk, Vertex* vertices, const ChunkSliceRange* range, const ChunkQuad* quads) {
+    for (u32 i = 0; i < range->QuadCount; i++) {
+        const u32 start[3] = { quads[i].Start[0], quads[i].Start[1], quads[i].Start[2] };
+        const u32 size[3] = { quads[i].Size[0], quads[i].Size[1], quads[i].Size[2] };
+        Chunk_WriteQuad(chunk, &vertices[i * 4], quads[i].Face, start, size, quads[i].AO);
+    }
+    memset(&vertices[range->QuadCount * 4], 0, (range->Capacity - range->QuadCount) * 4 * sizeof(Vertex));
+}
+
+void Chunk_UpdateMesh(Chunk* chunk) {
+    ASSERT(!chunk->JobPending);
+
+    if (chunk->ConnectionsDirty) {
+        chunk->ConnectionsDirty = FALSE;
+        Chunk_FindFaceConnections(chunk, chunk->Mesh.FaceConnections);
+    }
+    memcpy(chunk->FaceConnections, chunk->Mesh.FaceConnections, sizeof(chunk->FaceConnections));
+
+    ChunkSolidGrid grid = Chunk_GetSolidGrid(chunk);
+    u32 maxSize = Chunk_GetMaxSize(chunk);
+    ChunkQuad* sliceQuads = malloc(maxSize * maxSize * sizeof(ChunkQuad));
+
+    // The quads of the slices that outgrew their capacity, the index of each slice's first quad is in grownSlices
+    ChunkQuad* grownQuads = DynamicArrayCreate(ChunkQuad);
+    s32* grownSlices = NULL;
+
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        while (chunk->DirtySlices[face]) {
+            u32 slice = CountTrailingZeros64(chunk->DirtySlices[face]);
+            chunk->DirtySlices[face] &= chunk->DirtySlices[face] - 1;
+
+            ChunkSliceRange* range = Chunk_GetSliceRange(chunk, face, slice);
+            u32 quadCount = Chunk_FindSliceQuads(chunk, &grid, face, slice, sliceQuads);
+            range->QuadCount = quadCount;
+
+            if (quadCount <= range->Capacity) {
+                Chunk_WriteSlice(chunk, &chunk->Mesh.Vertices[range->FirstQuad * 4], range, sliceQuads);
+                Chunk_WriteArenaVertices(chunk->VertexOffset + range->FirstQuad * 4, range->Capacity * 4, &chunk->Mesh.Vertices[range->FirstQuad * 4]);
+            } else {
+                if (!grownSlices) {
+                    grownSlices = malloc(BlockFace_Count * maxSize * sizeof(s32));
+                    for (u32 i = 0; i < BlockFace_Count * maxSize; i++) {
+                        grownSlices[i] = -1;
+                    }
+                }
+                grownSlices[face * maxSize + slice] = cast(s32) DynamicArrayLength(grownQuads);
+                for (u32 i = 0; i < quadCount; i++) {
+                    DynamicArrayPush(grownQuads, sliceQuads[i]);
+                }
+            }
+        }
+    }
+
+    // Lay the whole mesh out again giving the slices that grew some room, edits tend to happen in the same place again
+    if (grownSlices) {
+        u32 totalQuads = 0;
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            for (u32 slice = 0; slice < Chunk_GetSliceCount(chunk, face); slice++) {
+                ChunkSliceRange* range = Chunk_GetSliceRange(chunk, face, slice);
+                if (grownSlices[face * maxSize + slice] >= 0) {
+                    range->Capacity = range->QuadCount + range->QuadCount / 2 + 1;
+                }
+                totalQuads += range->Capacity;
+            }
+        }
+
+        Vertex* vertices = DynamicArrayCreate_(cast(u64) totalQuads * 4, sizeof(Vertex));
+        DynamicArrayLength(vertices) = cast(u64) totalQuads * 4;
+
+        u32 firstQuad = 0;
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            chunk->Mesh.FaceRanges[face].FirstQuad = firstQuad;
+            for (u32 slice = 0; slice < Chunk_GetSliceCount(chunk, face); slice++) {
+                ChunkSliceRange* range = Chunk_GetSliceRange(chunk, face, slice);
+                s32 grownIndex = grownSlices[face * maxSize + slice];
+                if (grownIndex >= 0) {
+                    range->FirstQuad = firstQuad;
+                    Chunk_WriteSlice(chunk, &vertices[firstQuad * 4], range, &grownQuads[grownIndex]);
+                } else {
+                    memcpy(&vertices[firstQuad * 4], &chunk->Mesh.Vertices[range->FirstQuad * 4], range->Capacity * 4 * sizeof(Vertex));
+                    range->FirstQuad = firstQuad;
+                }
+                firstQuad += range->Capacity;
+            }
+            chunk->Mesh.FaceRanges[face].QuadCount = firstQuad - chunk->Mesh.FaceRanges[face].FirstQuad;
+        }
+
+        DynamicArrayDestroy(chunk->Mesh.Vertices);
+        chunk->Mesh.Vertices = vertices;
+        Chunk_UploadMesh(chunk);
+
+        free(grownSlices);
+    }
 
-    glGenBuffers(1, &chunk->IndexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk->IndexBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, DynamicArraySize(chunk->Indices), chunk->Indices, GL_STATIC_DRAW);
+    DynamicArrayDestroy(grownQuads);
+    free(sliceQuads);
 }
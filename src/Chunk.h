@@ -11,6 +11,52 @@ typedef enum BlockID {
     BlockID_Stone = 1,
 } BlockID;
 
+typedef enum BlockFace {
+    BlockFace_Top,    // +Y
+    BlockFace_Bottom, // -Y
+    BlockFace_Left,   // -X
+    BlockFace_Right,  // +X
+    BlockFace_Front,  // +Z
+    BlockFace_Back,   // -Z
+
+    BlockFace_Count,
+} BlockFace;
+
+#define CHUNK_ALL_FACES ((1 << BlockFace_Count) - 1)
+
+typedef enum ChunkMeshMode {
+    ChunkMeshMode_PerFace, // One quad per visible face, kept as a reference for the greedy mesher
+    ChunkMeshMode_Greedy,
+
+    ChunkMeshMode_Count,
+} ChunkMeshMode;
+
+// A range of quads in a chunk's mesh that all face the same direction
+typedef struct ChunkFaceRange {
+    u32 FirstQuad;
+    u32 QuadCount;
+} ChunkFaceRange;
+
+// The quads of one BlockFace direction in one slice of the chunk along that direction's axis.
+// The quads after QuadCount up to Capacity are degenerate so an edited slice can grow without moving the rest of the mesh
+typedef struct ChunkSliceRange {
+    u32 FirstQuad;
+    u32 QuadCount;
+    u32 Capacity;
+} ChunkSliceRange;
+
+// The CPU side output of the mesher, each face range is made of the slice ranges of that face back to back
+typedef struct ChunkMesh {
+    Vertex* Vertices;
+    ChunkFaceRange FaceRanges[BlockFace_Count];
+    ChunkSliceRange* SliceRanges; // Indexed by face * the largest chunk dimension + slice
+    // Bit per BlockFace for each BlockFace, set when air connects the two faces through the chunk
+    u8 FaceConnections[BlockFace_Count];
+} ChunkMesh;
+
+// Far chunks that are drawn together with the chunks around them, see Chunk.c
+typedef struct ChunkRegion ChunkRegion;
+
 typedef struct Chunk {
     struct {
         s64 x;
@@ -20,17 +66,92 @@ typedef struct Chunk {
     u32 Width;
     u32 Height;
     u32 Depth;
+    // Each block of the chunk covers 2^Lod world blocks along each axis, far away chunks use a higher Lod
+    // so the same number of blocks covers more of the world
+    u32 Lod;
+    // Bit per BlockFace, set when the chunk across that face is drawn at a different Lod.
+    // The blocks don't line up across those faces so the mesher treats them as air to close the seam
+    u8 LodSeams;
     u16* Blocks;
-    Vertex* Vertices;
-    u32* Indices;
-    GLuint VertexArray;
-    GLuint VertexBuffer;
-    GLuint IndexBuffer;
-    GLuint Shader;
+    u8* Solid; // Whether each block is solid with one block of padding on every side, kept up to date by Chunk_SetBlock
+    u64 DirtySlices[BlockFace_Count]; // Bit per slice of each face that Chunk_UpdateMesh needs to rebuild
+    b8 ConnectionsDirty;              // Set when an edit could have changed Mesh.FaceConnections in a way Chunk_SetBlock can't work out
+    ChunkMesh Mesh;
+    ChunkFaceRange FaceRanges[BlockFace_Count]; // The ranges of the mesh that was last uploaded
+    u8 FaceConnections[BlockFace_Count];        // And the face connections that came with it
+    // The chunk's block of the vertex arena shared by all chunks, in vertices. Can be larger than the mesh
+    u32 VertexOffset;
+    u32 VertexCapacity;
+    ChunkMeshMode MeshMode;
+    ChunkRegion* Region; // Joined when the chunk is first uploaded if its Lod is far enough to be merged
+
+    // Only touched by the main thread.
+    // While JobPending is set a worker owns Blocks and Mesh, and References counts the pending jobs reading this chunk's Blocks as a neighbor
+    b8 BlocksGenerated;
+    b8 JobPending;
+    u32 References;
+    b8 UploadPending; // Meshed and waiting in the upload queue, so Mesh doesn't match what's in the arena yet
+
+    // The faces the visibility search has entered the chunk through in VisibilityFrame
+    u8 VisibilityEnteredFaces;
+    u64 VisibilityFrame;
+
+    // The query tests the chunk's box against the depth of the frame it was issued in, its result is
+    // read in a later frame once it's available so drawing never waits on it
+    GLuint OcclusionQuery;
+    b8 OcclusionQueryPending;
+    b8 Occluded;
+    u64 OcclusionFrame; // The last draw the chunk was in the frustum in
 } Chunk;
 
-void Chunk_Create(Chunk* chunk, s64 x, s64 y, s64 z, u32 width, u32 height, u32 depth, GLuint shader);
+typedef struct ChunkDrawStats {
+    u64 Drawn;
+    u64 Commands; // Draw commands in the multi draw, a region is one command for all of its chunks
+    u64 Occluded; // In the frustum but skipped because the last occlusion query found the chunk's box hidden
+} ChunkDrawStats;
+
+// Sets up the chunk, the blocks and mesh are generated separately so that can be done on another thread
+void Chunk_Create(Chunk* chunk, s64 x, s64 y, s64 z, u32 width, u32 height, u32 depth, u32 lod, ChunkMeshMode meshMode);
 void Chunk_Destroy(Chunk* chunk);
 
-void Chunk_Draw(Chunk* chunk, Camera* camera);
-void Chunk_RecalculateMesh(Chunk* chunk);
+// Takes the chunk out of its region so the region stops drawing it, for when the chunk is unloaded
+// but can't be destroyed yet. Chunk_Destroy does this too
+void Chunk_LeaveRegion(Chunk* chunk);
+
+// Frees the GL resources shared by all chunks, call after every chunk has been destroyed
+void Chunk_DestroySharedResources();
+
+// Draws every chunk in the camera's frustum front to back with one glMultiDrawElementsIndirect, then draws their boxes with
+// occlusionShader into occlusion queries that decide which of them are skipped in the next frames.
+// An occlusionShader of 0 turns the occlusion culling off.
+// The camera's matrices have to be up to date, the shaders get them from the camera uniform block
+ChunkDrawStats Chunk_DrawChunks(Chunk** chunks, u64 chunkCount, GLuint shader, GLuint occlusionShader, Camera* camera);
+
+// The 26 chunks around a chunk, indexed by their offset in chunks along each axis. The center is the chunk itself and isn't used.
+// The padding at the edges and corners of a chunk comes from the chunks diagonal to it, so those are needed as well as the ones across each face
+#define CHUNK_NEIGHBOR_COUNT 27
+#define CHUNK_NEIGHBOR_CENTER 13
+
+static inline u32 ChunkNeighbor_Index(s32 x, s32 y, s32 z) {
+    return cast(u32) ((x + 1) + (y + 1) * 3 + (z + 1) * 9);
+}
+
+// These don't use GL so they can run on any thread.
+// neighbors holds the chunks with the same Lod around the chunk, NULL where that chunk isn't loaded or its blocks aren't generated yet
+void Chunk_GenerateBlocks(Chunk* chunk);
+void Chunk_GenerateMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]);
+
+// Must be called on the GL thread
+void Chunk_UploadMesh(Chunk* chunk);
+// Call once per frame after the uploads, lets the upload space they used and the arena space of replaced and
+// destroyed meshes be reused once the GPU is done with them
+void Chunk_FinishUploads();
+void Chunk_RecalculateMesh(Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]);
+
+// Sets a block at a chunk local position that may be one block outside of the chunk, which only updates the padding
+// so a block on the edge of a neighbor still culls the faces next to it. Marks the slices whose faces could have changed as dirty.
+// Only while no job has the chunk or reads it as a neighbor, the mesh must have been generated
+void Chunk_SetBlock(Chunk* chunk, s32 x, s32 y, s32 z, u16 block);
+// Rebuilds only the dirty slices and patches them into the vertex buffer in place, only slices that grow
+// past their capacity make the whole mesh get laid out and uploaded again. Must be called on the GL thread
+void Chunk_UpdateMesh(Chunk* chunk);
@@ -0,0 +1,93 @@
+#include "ChunkMap.h"
+
+#include <stdlib.h>
+
+static u64 ChunkMap_Hash(s64 x, s64 y, s64 z, u32 lod) {
+    u64 hash = cast(u64) x * 0x9E3779B97F4A7C15ull;
+    hash ^= cast(u64) y * 0xC2B2AE3D27D4EB4Full;
+    hash ^= cast(u64) z * 0x165667B19E3779F9ull;
+    hash ^= cast(u64) lod * 0x27D4EB2F165667C5ull;
+    return hash ^ (hash >> 29);
+}
+
+static b8 ChunkMap_Matches(Chunk* chunk, s64 x, s64 y, s64 z, u32 lod) {
+    return chunk->Position.x == x && chunk->Position.y == y && chunk->Position.z == z && chunk->Lod == lod;
+}
+
+void ChunkMap_Create(ChunkMap* map) {
+    const u64 InitialCapacity = 256;
+    *map = (ChunkMap){
+        .Slots = calloc(InitialCapacity, sizeof(Chunk*)),
+        .Capacity = InitialCapacity,
+        .Count = 0,
+    };
+}
+
+void ChunkMap_Destroy(ChunkMap* map) {
+    free(map->Slots);
+    *map = (ChunkMap){};
+}
+
+Chunk* ChunkMap_Find(ChunkMap* map, s64 x, s64 y, s64 z, u32 lod) {
+    u64 mask = map->Capacity - 1;
+    for (u64 i = ChunkMap_Hash(x, y, z, lod) & mask; map->Slots[i]; i = (i + 1) & mask) {
+        if (ChunkMap_Matches(map->Slots[i], x, y, z, lod)) {
+            return map->Slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void ChunkMap_InsertSlot(Chunk** slots, u64 capacity, Chunk* chunk) {
+    u64 mask = capacity - 1;
+    u64 i = ChunkMap_Hash(chunk->Position.x, chunk->Position.y, chunk->Position.z, chunk->Lod) & mask;
+    while (slots[i]) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = chunk;
+}
+
+void ChunkMap_Insert(ChunkMap* map, Chunk* chunk) {
+    ASSERT(!ChunkMap_Find(map, chunk->Position.x, chunk->Position.y, chunk->Position.z, chunk->Lod));
+
+    // Keep the table at most half full so the probe sequences stay short
+    if ((map->Count + 1) * 2 > map->Capacity) {
+        u64 newCapacity = map->Capacity * 2;
+        Chunk** newSlots = calloc(newCapacity, sizeof(Chunk*));
+        for (u64 i = 0; i < map->Capacity; i++) {
+            if (map->Slots[i]) {
+                ChunkMap_InsertSlot(newSlots, newCapacity, map->Slots[i]);
+            }
+        }
+        free(map->Slots);
+        map->Slots = newSlots;
+        map->Capacity = newCapacity;
+    }
+
+    ChunkMap_InsertSlot(map->Slots, map->Capacity, chunk);
+    map->Count++;
+}
+
+void ChunkMap_Remove(ChunkMap* map, Chunk* chunk) {
+    u64 mask = map->Capacity - 1;
+    u64 i = ChunkMap_Hash(chunk->Position.x, chunk->Position.y, chunk->Position.z, chunk->Lod) & mask;
+    while (map->Slots[i] != chunk) {
+        ASSERT(map->Slots[i]);
+        i = (i + 1) & mask;
+    }
+    map->Slots[i] = NULL;
+    map->Count--;
+
+    // Move back any chunks after the hole that could no longer be found past it, so no tombstones are needed
+    for (u64 j = (i + 1) & mask; map->Slots[j]; j = (j + 1) & mask) {
+        Chunk* other = map->Slots[j];
+        u64 home = ChunkMap_Hash(other->Position.x, other->Position.y, other->Position.z, other->Lod) & mask;
+        // Other can move into the hole if its home slot isn't cyclically between the hole and where it is now
+        b8 homeBetween = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!homeBetween) {
+            map->Slots[i] = other;
+            map->Slots[j] = NULL;
+            i = j;
+        }
+    }
+}
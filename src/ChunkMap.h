@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "Chunk.h"
+
+// Finds loaded chunks by their position and Lod, an open addressing hash table of chunk pointers
+typedef struct ChunkMap {
+    Chunk** Slots; // NULL for an empty slot
+    u64 Capacity;  // Always a power of 2
+    u64 Count;
+} ChunkMap;
+
+void ChunkMap_Create(ChunkMap* map);
+void ChunkMap_Destroy(ChunkMap* map);
+
+Chunk* ChunkMap_Find(ChunkMap* map, s64 x, s64 y, s64 z, u32 lod);
+// There must not already be a chunk at the same position and Lod
+void ChunkMap_Insert(ChunkMap* map, Chunk* chunk);
+void ChunkMap_Remove(ChunkMap* map, Chunk* chunk);
@@ -0,0 +1,170 @@
+#include "ChunkWorkers.h"
+#include "DynamicArray.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <Windows.h>
+
+typedef struct ChunkJob {
+    Chunk* Chunk;
+    Chunk* Neighbors[CHUNK_NEIGHBOR_COUNT];
+    b8 GenerateBlocks;
+} ChunkJob;
+
+typedef struct ChunkWorkers {
+    HANDLE* Threads;
+    u32 ThreadCount;
+
+    CRITICAL_SECTION Lock;
+    CONDITION_VARIABLE JobAvailable;
+    ChunkJob* Jobs;      // Waiting to be picked up, oldest first
+    ChunkJob* Completed; // Waiting for the main thread
+    b8 Quit;
+
+    // Only touched by the main thread
+    u64 PendingCount;
+} ChunkWorkers;
+
+static DWORD WINAPI ChunkWorkers_ThreadMain(LPVOID userData) {
+    ChunkWorkers* workers = userData;
+
+    while (TRUE) {
+        ChunkJob job;
+
+        EnterCriticalSection(&workers->Lock);
+        while (!workers->Quit && DynamicArrayLength(workers->Jobs) == 0) {
+            SleepConditionVariableCS(&workers->JobAvailable, &workers->Lock, INFINITE);
+        }
+        if (workers->Quit) {
+            LeaveCriticalSection(&workers->Lock);
+            break;
+        }
+        DynamicArrayPopAt(workers->Jobs, 0, &job);
+        LeaveCriticalSection(&workers->Lock);
+
+        if (job.GenerateBlocks) {
+            Chunk_GenerateBlocks(job.Chunk);
+        }
+        Chunk_GenerateMesh(job.Chunk, job.Neighbors);
+
+        EnterCriticalSection(&workers->Lock);
+        DynamicArrayPush(workers->Completed, job);
+        LeaveCriticalSection(&workers->Lock);
+    }
+
+    return 0;
+}
+
+ChunkWorkers* ChunkWorkers_Create(u32 threadCount) {
+    if (threadCount == 0) {
+        SYSTEM_INFO systemInfo = {};
+        GetSystemInfo(&systemInfo);
+        threadCount = systemInfo.dwNumberOfProcessors > 1 ? systemInfo.dwNumberOfProcessors - 1 : 1;
+    }
+
+    ChunkWorkers* workers = malloc(sizeof(ChunkWorkers));
+    *workers = (ChunkWorkers){
+        .Threads = malloc(threadCount * sizeof(HANDLE)),
+        .ThreadCount = threadCount,
+        .Jobs = DynamicArrayCreate(ChunkJob),
+        .Completed = DynamicArrayCreate(ChunkJob),
+        .Quit = FALSE,
+        .PendingCount = 0,
+    };
+
+    InitializeCriticalSection(&workers->Lock);
+    InitializeConditionVariable(&workers->JobAvailable);
+
+    for (u32 i = 0; i < threadCount; i++) {
+        workers->Threads[i] = CreateThread(NULL, 0, ChunkWorkers_ThreadMain, workers, 0, NULL);
+        ASSERT(workers->Threads[i]);
+    }
+
+    return workers;
+}
+
+void ChunkWorkers_Destroy(ChunkWorkers* workers) {
+    EnterCriticalSection(&workers->Lock);
+    workers->Quit = TRUE;
+    LeaveCriticalSection(&workers->Lock);
+    WakeAllConditionVariable(&workers->JobAvailable);
+
+    for (u32 i = 0; i < workers->ThreadCount; i++) {
+        WaitForSingleObject(workers->Threads[i], INFINITE);
+        CloseHandle(workers->Threads[i]);
+    }
+
+    // Hand the chunks back to the main thread so they can be destroyed
+    for (u64 i = 0; i < DynamicArrayLength(workers->Jobs); i++) {
+        ChunkJob* job = &workers->Jobs[i];
+        job->Chunk->JobPending = FALSE;
+        for (u32 i = 0; i < CHUNK_NEIGHBOR_COUNT; i++) {
+            if (job->Neighbors[i]) {
+                job->Neighbors[i]->References--;
+            }
+        }
+    }
+
+    Chunk* chunk = NULL;
+    while (ChunkWorkers_PopCompleted(workers, &chunk)) {
+    }
+
+    DeleteCriticalSection(&workers->Lock);
+    DynamicArrayDestroy(workers->Jobs);
+    DynamicArrayDestroy(workers->Completed);
+    free(workers->Threads);
+    free(workers);
+}
+
+void ChunkWorkers_Submit(ChunkWorkers* workers, Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]) {
+    ASSERT(!chunk->JobPending);
+
+    ChunkJob job = {
+        .Chunk = chunk,
+        .GenerateBlocks = !chunk->BlocksGenerated,
+    };
+
+    chunk->JobPending = TRUE;
+    for (u32 i = 0; i < CHUNK_NEIGHBOR_COUNT; i++) {
+        // A neighbor's blocks can only be read once they have been generated
+        if (neighbors[i] && neighbors[i]->BlocksGenerated) {
+            job.Neighbors[i] = neighbors[i];
+            neighbors[i]->References++;
+        }
+    }
+    workers->PendingCount++;
+
+    EnterCriticalSection(&workers->Lock);
+    DynamicArrayPush(workers->Jobs, job);
+    LeaveCriticalSection(&workers->Lock);
+    WakeConditionVariable(&workers->JobAvailable);
+}
+
+b8 ChunkWorkers_PopCompleted(ChunkWorkers* workers, Chunk** outChunk) {
+    ChunkJob job;
+
+    EnterCriticalSection(&workers->Lock);
+    if (DynamicArrayLength(workers->Completed) == 0) {
+        LeaveCriticalSection(&workers->Lock);
+        return FALSE;
+    }
+    DynamicArrayPop(workers->Completed, &job);
+    LeaveCriticalSection(&workers->Lock);
+
+    job.Chunk->JobPending = FALSE;
+    job.Chunk->BlocksGenerated = TRUE;
+    for (u32 i = 0; i < CHUNK_NEIGHBOR_COUNT; i++) {
+        if (job.Neighbors[i]) {
+            job.Neighbors[i]->References--;
+        }
+    }
+    workers->PendingCount--;
+
+    *outChunk = job.Chunk;
+    return TRUE;
+}
+
+u64 ChunkWorkers_GetPendingCount(ChunkWorkers* workers) {
+    return workers->PendingCount;
+}
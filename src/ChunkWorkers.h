@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "Chunk.h"
+
+// A pool of threads that generate chunk blocks and meshes off of the main thread.
+// Finished chunks go into a completion queue so the main thread only has to upload them.
+typedef struct ChunkWorkers ChunkWorkers;
+
+// A threadCount of 0 uses one thread per core, leaving one core for the main thread
+ChunkWorkers* ChunkWorkers_Create(u32 threadCount);
+// Waits for the jobs that are running to finish, jobs that haven't started are dropped
+void ChunkWorkers_Destroy(ChunkWorkers* workers);
+
+// Generates the chunk's blocks if they haven't been generated yet and then its mesh.
+// Sets JobPending on the chunk and takes a reference on each neighbor until the job is popped from ChunkWorkers_PopCompleted.
+void ChunkWorkers_Submit(ChunkWorkers* workers, Chunk* chunk, Chunk* neighbors[CHUNK_NEIGHBOR_COUNT]);
+// Returns FALSE when there are no completed jobs, otherwise clears JobPending, releases the neighbor references and sets BlocksGenerated
+b8 ChunkWorkers_PopCompleted(ChunkWorkers* workers, Chunk** outChunk);
+
+u64 ChunkWorkers_GetPendingCount(ChunkWorkers* workers);
@@ -41,6 +41,19 @@ void* DynamicArrayPop_(void* array, void* dest) {
     return array;
 }
 
+void* DynamicArrayReserve_(void* array, u64 capacity) {
+    if (capacity <= DynamicArrayCapacity(array)) {
+        return array;
+    }
+
+    void* newArray = DynamicArrayCreate_(capacity, DynamicArrayStride(array));
+    memcpy(newArray, array, DynamicArraySize(array));
+    DynamicArrayLength(newArray) = DynamicArrayLength(array);
+
+    DynamicArrayDestroy(array);
+    return newArray;
+}
+
 void* DynamicArrayInsert_(void* array, u64 index, const void* valuePtr) {
     if (index > DynamicArrayLength(array)) {
         return array;
@@ -77,7 +90,7 @@ void* DynamicArrayPopAt_(void* array, u64 index, void* dest) {
     if (dest) {
         memcpy(dest, &(cast(u8*) array)[index * DynamicArrayStride(array)], DynamicArrayStride(array));
     }
-    memmove(&(cast(u8*) array)[index * DynamicArrayStride(array)], &(cast(u8*) array)[(index + 1) * DynamicArrayStride(array)], (DynamicArrayLength(array) - index) * DynamicArrayStride(array));
+    memmove(&(cast(u8*) array)[index * DynamicArrayStride(array)], &(cast(u8*) array)[(index + 1) * DynamicArrayStride(array)], (DynamicArrayLength(array) - index - 1) * DynamicArrayStride(array));
     DynamicArrayLength(array)--;
     return array;
 }
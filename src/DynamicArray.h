@@ -16,6 +16,9 @@ void DynamicArrayDestroy_(void* array);
 void* DynamicArrayPush_(void* array, const void* valuePtr);
 void* DynamicArrayPop_(void* array, void* dest);
 
+// Grows the capacity to exactly capacity elements if it is smaller, the length is unchanged
+void* DynamicArrayReserve_(void* array, u64 capacity);
+
 void* DynamicArrayInsert_(void* array, u64 index, const void* valuePtr);
 void* DynamicArrayPopAt_(void* array, u64 index, void* dest);
 
@@ -36,6 +39,11 @@ void* DynamicArrayPopAt_(void* array, u64 index, void* dest);
         (array) = DynamicArrayPop_((array), (dest)); \
     } while (0)
 
+#define DynamicArrayReserve(array, capacity) \
+    do { \
+        (array) = DynamicArrayReserve_((array), (capacity)); \
+    } while (0)
+
 #define DynamicArrayInsert(array, index, value) \
     do { \
         __typeof__(*(array)) temp = (value); \
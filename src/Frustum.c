@@ -0,0 +1,86 @@
+#include "Frustum.h"
+
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define FRUSTUM_SSE 1
+#endif
+
+void Frustum_FromMatrix(Frustum* frustum, mat4 viewProjection) {
+    glm_frustum_planes(viewProjection, frustum->Planes);
+}
+
+void FrustumBoxes_Create(FrustumBoxes* boxes) {
+    *boxes = (FrustumBoxes){};
+}
+
+void FrustumBoxes_Destroy(FrustumBoxes* boxes) {
+    for (u32 axis = 0; axis < 3; axis++) {
+        free(boxes->Centers[axis]);
+        free(boxes->Extents[axis]);
+    }
+    *boxes = (FrustumBoxes){};
+}
+
+void FrustumBoxes_Push(FrustumBoxes* boxes, vec3 min, vec3 max) {
+    if (boxes->Count == boxes->Capacity) {
+        // The boxes past Count are tested along with the last real ones and their results ignored
+        boxes->Capacity = boxes->Capacity != 0 ? boxes->Capacity * 2 : 64;
+        for (u32 axis = 0; axis < 3; axis++) {
+            boxes->Centers[axis] = realloc(boxes->Centers[axis], boxes->Capacity * sizeof(f32));
+            boxes->Extents[axis] = realloc(boxes->Extents[axis], boxes->Capacity * sizeof(f32));
+        }
+    }
+
+    for (u32 axis = 0; axis < 3; axis++) {
+        boxes->Centers[axis][boxes->Count] = (min[axis] + max[axis]) * 0.5f;
+        boxes->Extents[axis][boxes->Count] = (max[axis] - min[axis]) * 0.5f;
+    }
+    boxes->Count++;
+}
+
+// A box is outside a plane when even its corner furthest along the plane's normal is behind it.
+// That corner is center + extent * sign(normal), so its distance is dot(normal, center) + w + dot(|normal|, extent)
+void Frustum_TestBoxes(Frustum* frustum, FrustumBoxes* boxes, b8* outVisible) {
+#if FRUSTUM_SSE
+    for (u64 i = 0; i < boxes->Count; i += 4) {
+        __m128 centerX = _mm_loadu_ps(&boxes->Centers[0][i]);
+        __m128 centerY = _mm_loadu_ps(&boxes->Centers[1][i]);
+        __m128 centerZ = _mm_loadu_ps(&boxes->Centers[2][i]);
+        __m128 extentX = _mm_loadu_ps(&boxes->Extents[0][i]);
+        __m128 extentY = _mm_loadu_ps(&boxes->Extents[1][i]);
+        __m128 extentZ = _mm_loadu_ps(&boxes->Extents[2][i]);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (u32 p = 0; p < 6; p++) {
+            f32* plane = frustum->Planes[p];
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane[0])), _mm_mul_ps(centerY, _mm_set1_ps(plane[1]))),
+                _mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3]))
+            );
+            __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(fabsf(plane[0]))), _mm_mul_ps(extentY, _mm_set1_ps(fabsf(plane[1])))),
+                _mm_mul_ps(extentZ, _mm_set1_ps(fabsf(plane[2])))
+            );
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        u32 mask = cast(u32) _mm_movemask_ps(inside);
+        for (u64 lane = 0; lane < 4 && i + lane < boxes->Count; lane++) {
+            outVisible[i + lane] = (mask >> lane) & 1;
+        }
+    }
+#else
+    for (u64 i = 0; i < boxes->Count; i++) {
+        b8 inside = TRUE;
+        for (u32 p = 0; p < 6 && inside; p++) {
+            f32* plane = frustum->Planes[p];
+            f32 distance = boxes->Centers[0][i] * plane[0] + boxes->Centers[1][i] * plane[1] + boxes->Centers[2][i] * plane[2] + plane[3];
+            f32 radius = boxes->Extents[0][i] * fabsf(plane[0]) + boxes->Extents[1][i] * fabsf(plane[1]) + boxes->Extents[2][i] * fabsf(plane[2]);
+            inside = distance + radius >= 0.0f;
+        }
+        outVisible[i] = inside;
+    }
+#endif
+}
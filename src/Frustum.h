@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Typedefs.h"
+#include <cglm/cglm.h>
+
+// World space planes of the camera's view, a point is inside a plane when dot(plane.xyz, point) + plane.w >= 0
+typedef struct Frustum {
+    vec4 Planes[6];
+} Frustum;
+
+// Axis aligned boxes stored as one array per component so the frustum test can do four boxes at once.
+// The arrays are always allocated to a multiple of 4 boxes
+typedef struct FrustumBoxes {
+    f32* Centers[3];
+    f32* Extents[3]; // Half the size of the box along each axis
+    u64 Count;
+    u64 Capacity;
+} FrustumBoxes;
+
+void Frustum_FromMatrix(Frustum* frustum, mat4 viewProjection);
+
+void FrustumBoxes_Create(FrustumBoxes* boxes);
+void FrustumBoxes_Destroy(FrustumBoxes* boxes);
+void FrustumBoxes_Push(FrustumBoxes* boxes, vec3 min, vec3 max);
+
+// Sets outVisible[i] for every box that is at least partly inside the frustum
+void Frustum_TestBoxes(Frustum* frustum, FrustumBoxes* boxes, b8* outVisible);
@@ -0,0 +1,119 @@
+#include "GPUTimer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void GPUTimer_Create(GPUTimer* timer) {
+    *timer = (GPUTimer){};
+    for (u32 i = 0; i < GPU_TIMER_FRAME_COUNT; i++) {
+        glGenQueries(GPU_TIMER_MAX_PASSES * 2, timer->Frames[i].Queries);
+    }
+}
+
+void GPUTimer_Destroy(GPUTimer* timer) {
+    for (u32 i = 0; i < GPU_TIMER_FRAME_COUNT; i++) {
+        glDeleteQueries(GPU_TIMER_MAX_PASSES * 2, timer->Frames[i].Queries);
+    }
+    *timer = (GPUTimer){};
+}
+
+static u32 GPUTimer_FindPass(GPUTimer* timer, const char* name) {
+    for (u32 i = 0; i < timer->PassCount; i++) {
+        if (strcmp(timer->Passes[i].Name, name) == 0) {
+            return i;
+        }
+    }
+
+    ASSERT(timer->PassCount < GPU_TIMER_MAX_PASSES);
+    timer->Passes[timer->PassCount] = (GPUTimerPass){ .Name = name };
+    return timer->PassCount++;
+}
+
+// Returns FALSE without reading anything if the GPU hasn't got to the end of the frame yet
+static b8 GPUTimer_ReadFrame(GPUTimer* timer, GPUTimerFrame* frame) {
+    // The timestamps finish in order so the last one being available means they all are
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(frame->Queries[frame->PassCount * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return FALSE;
+    }
+
+    for (u32 i = 0; i < frame->PassCount; i++) {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(frame->Queries[i * 2], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(frame->Queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+        GPUTimerPass* pass = &timer->Passes[frame->PassIndices[i]];
+        pass->History[pass->SampleCount % GPU_TIMER_HISTORY_SIZE] = cast(f64) (end - start) / 1000000.0;
+        pass->SampleCount++;
+    }
+    return TRUE;
+}
+
+void GPUTimer_BeginFrame(GPUTimer* timer) {
+    // Oldest first, the current frame is the newest
+    for (u64 i = 1; i <= GPU_TIMER_FRAME_COUNT; i++) {
+        GPUTimerFrame* frame = &timer->Frames[(timer->FrameIndex + i) % GPU_TIMER_FRAME_COUNT];
+        if (frame->Pending && frame->PassCount > 0 && GPUTimer_ReadFrame(timer, frame)) {
+            frame->Pending = FALSE;
+        }
+    }
+
+    // A frame the GPU still hasn't finished after a whole lap of the ring is dropped rather than waited for,
+    // writing a query again replaces its old result
+    timer->FrameIndex++;
+    GPUTimerFrame* frame = &timer->Frames[timer->FrameIndex % GPU_TIMER_FRAME_COUNT];
+    frame->PassCount = 0;
+    frame->PassOpen = FALSE;
+    frame->Pending = TRUE;
+}
+
+void GPUTimer_BeginPass(GPUTimer* timer, const char* name) {
+    GPUTimerFrame* frame = &timer->Frames[timer->FrameIndex % GPU_TIMER_FRAME_COUNT];
+    ASSERT(frame->Pending && !frame->PassOpen && frame->PassCount < GPU_TIMER_MAX_PASSES);
+
+    frame->PassIndices[frame->PassCount] = GPUTimer_FindPass(timer, name);
+    frame->PassOpen = TRUE;
+    glQueryCounter(frame->Queries[frame->PassCount * 2], GL_TIMESTAMP);
+}
+
+void GPUTimer_EndPass(GPUTimer* timer) {
+    GPUTimerFrame* frame = &timer->Frames[timer->FrameIndex % GPU_TIMER_FRAME_COUNT];
+    ASSERT(frame->Pending && frame->PassOpen);
+
+    glQueryCounter(frame->Queries[frame->PassCount * 2 + 1], GL_TIMESTAMP);
+    frame->PassOpen = FALSE;
+    frame->PassCount++;
+}
+
+static int GPUTimer_CompareTimes(const void* a, const void* b) {
+    f64 timeA = *cast(const f64*) a;
+    f64 timeB = *cast(const f64*) b;
+    return (timeA > timeB) - (timeA < timeB);
+}
+
+b8 GPUTimer_GetStats(GPUTimer* timer, u32 passIndex, GPUTimerStats* outStats) {
+    ASSERT(passIndex < timer->PassCount);
+    GPUTimerPass* pass = &timer->Passes[passIndex];
+    u64 count = pass->SampleCount < GPU_TIMER_HISTORY_SIZE ? pass->SampleCount : GPU_TIMER_HISTORY_SIZE;
+    if (count == 0) {
+        return FALSE;
+    }
+
+    f64 sorted[GPU_TIMER_HISTORY_SIZE];
+    memcpy(sorted, pass->History, count * sizeof(f64));
+    qsort(sorted, count, sizeof(f64), GPUTimer_CompareTimes);
+
+    f64 total = 0.0;
+    for (u64 i = 0; i < count; i++) {
+        total += sorted[i];
+    }
+
+    // Nearest rank percentiles
+    *outStats = (GPUTimerStats){
+        .Average = total / cast(f64) count,
+        .Median = sorted[(count - 1) / 2],
+        .Percentile95 = sorted[((count * 95) + 99) / 100 - 1],
+    };
+    return TRUE;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "OpenGL.h"
+
+#define GPU_TIMER_MAX_PASSES 8
+// Frames of queries in flight, a frame's timestamps are read this many frames after they were written
+#define GPU_TIMER_FRAME_COUNT 4
+// Frames of results kept per pass for the averages and percentiles
+#define GPU_TIMER_HISTORY_SIZE 128
+
+typedef struct GPUTimerPass {
+    const char* Name;
+    f64 History[GPU_TIMER_HISTORY_SIZE]; // In milliseconds, the oldest is overwritten first
+    u64 SampleCount;
+} GPUTimerPass;
+
+// The timestamps one frame wrote, a pair for each pass with its start and then its end
+typedef struct GPUTimerFrame {
+    GLuint Queries[GPU_TIMER_MAX_PASSES * 2];
+    u32 PassIndices[GPU_TIMER_MAX_PASSES];
+    u32 PassCount;  // Passes that have ended
+    b8 PassOpen;    // A pass has begun and not ended yet
+    b8 Pending;     // The queries have been written and not read yet
+} GPUTimerFrame;
+
+// Measures how long the GPU spends on each pass of a frame with timestamp queries. The results are read back
+// a few frames later once the GPU has them, so measuring never makes the CPU wait for the GPU
+typedef struct GPUTimer {
+    GPUTimerFrame Frames[GPU_TIMER_FRAME_COUNT];
+    u64 FrameIndex;
+    GPUTimerPass Passes[GPU_TIMER_MAX_PASSES];
+    u32 PassCount;
+} GPUTimer;
+
+typedef struct GPUTimerStats {
+    f64 Average;
+    f64 Median;
+    f64 Percentile95;
+} GPUTimerStats;
+
+void GPUTimer_Create(GPUTimer* timer);
+void GPUTimer_Destroy(GPUTimer* timer);
+
+// Reads back the frames the GPU has finished and starts timing a new frame
+void GPUTimer_BeginFrame(GPUTimer* timer);
+// A pass is the GL work issued between its begin and end, passes can't overlap. name has to outlive the timer.
+// Anything the CPU does in between counts too if the GPU runs out of work, so keep the passes tight around the GL calls
+void GPUTimer_BeginPass(GPUTimer* timer, const char* name);
+void GPUTimer_EndPass(GPUTimer* timer);
+
+// In milliseconds over the last GPU_TIMER_HISTORY_SIZE frames that had the pass, FALSE if there aren't any yet
+b8 GPUTimer_GetStats(GPUTimer* timer, u32 passIndex, GPUTimerStats* outStats);
@@ -10,6 +10,10 @@
 #include "Shader.h"
 #include "Camera.h"
 #include "Chunk.h"
+#include "ChunkWorkers.h"
+#include "ChunkMap.h"
+#include "GPUTimer.h"
+#include "BlockTextures.h"
 #include "stb_image.h"
 
 #include <stdio.h>
@@ -39,6 +43,13 @@ static b8 QPressed = FALSE;
 static b8 EPressed = FALSE;
 static b8 ShiftPressed = FALSE;
 static b8 ChunkLoadingDisabled = FALSE;
+static b8 CaveCullingDisabled = FALSE;
+static b8 OcclusionCullingDisabled = FALSE;
+static b8 WireframeEnabled = FALSE;
+static ChunkMeshMode MeshMode = ChunkMeshMode_Greedy;
+static b8 MeshModeChanged = FALSE;
+static b8 BreakBlockRequested = FALSE;
+static b8 PlaceBlockRequested = FALSE;
 static void WindowKeyCallback(Window* window, u32 key, b8 pressed, void* userData) {
     switch (key) {
         case 'W': {
@@ -67,11 +78,12 @@ static void WindowKeyCallback(Window* window, u32 key, b8 pressed, void* userDat
 
         case 'R': {
             // NOTE: This requires a compatability context? Should this be used?
+            WireframeEnabled = pressed;
             if (pressed) {
-                glDisable(GL_CULL_FACE);
+                GLState_Disable(GL_CULL_FACE);
                 glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
             } else {
-                glEnable(GL_CULL_FACE);
+                GLState_Enable(GL_CULL_FACE);
                 glCullFace(GL_FRONT);
                 glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
             }
@@ -83,6 +95,37 @@ static void WindowKeyCallback(Window* window, u32 key, b8 pressed, void* userDat
             }
         } break;
 
+        case 'V': {
+            if (pressed) {
+                CaveCullingDisabled = !CaveCullingDisabled;
+            }
+        } break;
+
+        case 'O': {
+            if (pressed) {
+                OcclusionCullingDisabled = !OcclusionCullingDisabled;
+            }
+        } break;
+
+        case 'G': {
+            if (pressed) {
+                MeshMode = (MeshMode + 1) % ChunkMeshMode_Count;
+                MeshModeChanged = TRUE;
+            }
+        } break;
+
+        case 'X': {
+            if (pressed) {
+                BreakBlockRequested = TRUE;
+            }
+        } break;
+
+        case 'C': {
+            if (pressed) {
+                PlaceBlockRequested = TRUE;
+            }
+        } break;
+
         case 0x1B: { // TODO: This is escape replace this later its windows specific
             static b8 Locked = TRUE;
             if (pressed) {
@@ -110,6 +153,458 @@ static void WindowMouseMoveCallback(Window* window, s32 deltaX, s32 deltaY, void
     MouseYDelta += deltaY;
 }
 
+static void GetCameraForward(Camera* camera, vec3 outForward) {
+    outForward[0] = sinf(camera->Transform.Rotation[1] * cast(f32) (M_PI / 180.0)) * cosf(camera->Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
+    outForward[1] = -sinf(camera->Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
+    outForward[2] = cosf(camera->Transform.Rotation[1] * cast(f32) (M_PI / 180.0)) * cosf(camera->Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
+    glm_vec3_normalize(outForward);
+}
+
+static void FindChunkNeighbors(ChunkMap* chunkMap, Chunk* chunk, Chunk* outNeighbors[CHUNK_NEIGHBOR_COUNT]) {
+    s64 size = cast(s64) chunk->Width << chunk->Lod;
+    for (s32 z = -1; z <= 1; z++) {
+        for (s32 y = -1; y <= 1; y++) {
+            for (s32 x = -1; x <= 1; x++) {
+                u32 index = ChunkNeighbor_Index(x, y, z);
+                outNeighbors[index] = index == CHUNK_NEIGHBOR_CENTER ? NULL : ChunkMap_Find(chunkMap,
+                    chunk->Position.x + x * size, chunk->Position.y + y * size, chunk->Position.z + z * size, chunk->Lod);
+            }
+        }
+    }
+}
+
+#define CHUNK_SIZE 8
+#define CHUNK_LOD_COUNT 4
+
+// Cells closer to the camera than this are split into the 8 cells of the Lod below them, indexed by Lod - 1
+static const f32 ChunkLodSplitDistances[CHUNK_LOD_COUNT - 1] = { 40.0f, 80.0f, 120.0f };
+static const f32 ChunkViewDistance = 160.0f;
+// How many bytes of finished meshes are uploaded per frame, the rest wait in the upload queue
+static const u64 ChunkUploadBudget = 256 * 1024;
+
+// A cell of the chunk grid at a Lod, cells are CHUNK_SIZE << Lod world blocks across and line up
+// so that every cell is covered exactly by the 8 cells below it
+typedef struct ChunkCell {
+    s64 x;
+    s64 y;
+    s64 z;
+    u32 Lod;
+} ChunkCell;
+
+static s64 FloorDivide(s64 a, s64 b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+static s64 ChunkCell_GetSize(u32 lod) {
+    return cast(s64) CHUNK_SIZE << lod;
+}
+
+// The cell at the Lod that contains a world block
+static ChunkCell ChunkCell_FromBlock(s64 x, s64 y, s64 z, u32 lod) {
+    s64 size = ChunkCell_GetSize(lod);
+    return (ChunkCell){
+        .x = FloorDivide(x + CHUNK_SIZE / 2, size),
+        .y = FloorDivide(y + CHUNK_SIZE / 2, size),
+        .z = FloorDivide(z + CHUNK_SIZE / 2, size),
+        .Lod = lod,
+    };
+}
+
+static ChunkCell ChunkCell_FromChunk(Chunk* chunk) {
+    return ChunkCell_FromBlock(chunk->Position.x, chunk->Position.y, chunk->Position.z, chunk->Lod);
+}
+
+// The center block of the cell, which is the position of its chunk
+static void ChunkCell_GetChunkPosition(ChunkCell cell, s64* outX, s64* outY, s64* outZ) {
+    s64 size = ChunkCell_GetSize(cell.Lod);
+    *outX = cell.x * size - CHUNK_SIZE / 2 + size / 2;
+    *outY = cell.y * size - CHUNK_SIZE / 2 + size / 2;
+    *outZ = cell.z * size - CHUNK_SIZE / 2 + size / 2;
+}
+
+// Distance from the position to the closest point of the cell
+static f32 ChunkCell_GetDistance(ChunkCell cell, vec3 position) {
+    f32 size = cast(f32) ChunkCell_GetSize(cell.Lod);
+    const s64 coords[3] = { cell.x, cell.y, cell.z };
+
+    f32 distanceSquared = 0.0f;
+    for (u32 axis = 0; axis < 3; axis++) {
+        f32 min = cast(f32) coords[axis] * size - cast(f32) (CHUNK_SIZE / 2) - 0.5f;
+        f32 max = min + size;
+        f32 distance = 0.0f;
+        if (position[axis] < min) {
+            distance = min - position[axis];
+        } else if (position[axis] > max) {
+            distance = position[axis] - max;
+        }
+        distanceSquared += distance * distance;
+    }
+    return sqrtf(distanceSquared);
+}
+
+static b8 ChunkCell_ShouldSplit(ChunkCell cell, vec3 cameraPosition) {
+    return cell.Lod > 0 && ChunkCell_GetDistance(cell, cameraPosition) < ChunkLodSplitDistances[cell.Lod - 1];
+}
+
+// Whether the cell should have a chunk, which is when it's in view and every cell above it was split but it wasn't
+static b8 ChunkCell_IsWanted(ChunkCell cell, vec3 cameraPosition) {
+    if (ChunkCell_GetDistance(cell, cameraPosition) >= ChunkViewDistance || ChunkCell_ShouldSplit(cell, cameraPosition)) {
+        return FALSE;
+    }
+
+    ChunkCell parent = cell;
+    while (parent.Lod + 1 < CHUNK_LOD_COUNT) {
+        parent = (ChunkCell){ FloorDivide(parent.x, 2), FloorDivide(parent.y, 2), FloorDivide(parent.z, 2), parent.Lod + 1 };
+        if (!ChunkCell_ShouldSplit(parent, cameraPosition)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// The cell whose chunk covers the world block, or FALSE if it's out of view
+static b8 ChunkCell_FindWantedAt(s64 x, s64 y, s64 z, vec3 cameraPosition, ChunkCell* outCell) {
+    ChunkCell cell = ChunkCell_FromBlock(x, y, z, CHUNK_LOD_COUNT - 1);
+    while (ChunkCell_ShouldSplit(cell, cameraPosition)) {
+        cell = ChunkCell_FromBlock(x, y, z, cell.Lod - 1);
+    }
+    *outCell = cell;
+    return ChunkCell_GetDistance(cell, cameraPosition) < ChunkViewDistance;
+}
+
+static const s64 BlockFaceOffsets[BlockFace_Count][3] = {
+    [BlockFace_Top]    = {  0,  1,  0 },
+    [BlockFace_Bottom] = {  0, -1,  0 },
+    [BlockFace_Left]   = { -1,  0,  0 },
+    [BlockFace_Right]  = {  1,  0,  0 },
+    [BlockFace_Front]  = {  0,  0,  1 },
+    [BlockFace_Back]   = {  0,  0, -1 },
+};
+
+// Bit per BlockFace for the sides of the cell where the chunk across from it has a different Lod
+static u8 ChunkCell_GetLodSeams(ChunkCell cell, vec3 cameraPosition) {
+    s64 size = ChunkCell_GetSize(cell.Lod);
+    s64 x, y, z;
+    ChunkCell_GetChunkPosition(cell, &x, &y, &z);
+
+    u8 seams = 0;
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        ChunkCell neighbor;
+        if (ChunkCell_FindWantedAt(x + BlockFaceOffsets[face][0] * size, y + BlockFaceOffsets[face][1] * size, z + BlockFaceOffsets[face][2] * size, cameraPosition, &neighbor) &&
+            neighbor.Lod != cell.Lod) {
+            seams |= 1 << face;
+        }
+    }
+    return seams;
+}
+
+// Adds the cells under cell that should have a chunk
+static void ChunkCell_CollectWanted(ChunkCell cell, vec3 cameraPosition, ChunkCell** wantedCells) {
+    if (ChunkCell_GetDistance(cell, cameraPosition) >= ChunkViewDistance) {
+        return;
+    }
+
+    if (!ChunkCell_ShouldSplit(cell, cameraPosition)) {
+        DynamicArrayPush(*wantedCells, cell);
+        return;
+    }
+
+    for (s64 i = 0; i < 8; i++) {
+        ChunkCell child = {
+            .x = cell.x * 2 + (i & 1),
+            .y = cell.y * 2 + ((i >> 1) & 1),
+            .z = cell.z * 2 + ((i >> 2) & 1),
+            .Lod = cell.Lod - 1,
+        };
+        ChunkCell_CollectWanted(child, cameraPosition, wantedCells);
+    }
+}
+
+// Adds the chunks inside the cell that touch its side in the direction of face
+static void ChunkCell_FindChunksAtFace(ChunkMap* chunkMap, ChunkCell cell, BlockFace face, Chunk*** outChunks) {
+    s64 x, y, z;
+    ChunkCell_GetChunkPosition(cell, &x, &y, &z);
+    Chunk* chunk = ChunkMap_Find(chunkMap, x, y, z, cell.Lod);
+    if (chunk) {
+        DynamicArrayPush(*outChunks, chunk);
+        return;
+    }
+
+    if (cell.Lod == 0) {
+        return;
+    }
+
+    for (s64 i = 0; i < 8; i++) {
+        const s64 half[3] = { i & 1, (i >> 1) & 1, (i >> 2) & 1 };
+        b8 atFace = TRUE;
+        for (u32 axis = 0; axis < 3; axis++) {
+            if (BlockFaceOffsets[face][axis] != 0 && half[axis] != (BlockFaceOffsets[face][axis] > 0)) {
+                atFace = FALSE;
+            }
+        }
+
+        if (atFace) {
+            ChunkCell child = { cell.x * 2 + half[0], cell.y * 2 + half[1], cell.z * 2 + half[2], cell.Lod - 1 };
+            ChunkCell_FindChunksAtFace(chunkMap, child, face, outChunks);
+        }
+    }
+}
+
+// Adds the chunks across a face of the cell. That is the chunk of the cell next to it if there is one,
+// otherwise the bigger chunk that covers that cell or the smaller chunks of it that touch the face
+static void ChunkCell_FindFaceNeighbors(ChunkMap* chunkMap, ChunkCell cell, BlockFace face, Chunk*** outNeighbors) {
+    ChunkCell adjacent = { cell.x + BlockFaceOffsets[face][0], cell.y + BlockFaceOffsets[face][1], cell.z + BlockFaceOffsets[face][2], cell.Lod };
+    for (ChunkCell covering = adjacent; covering.Lod < CHUNK_LOD_COUNT;) {
+        s64 x, y, z;
+        ChunkCell_GetChunkPosition(covering, &x, &y, &z);
+        Chunk* chunk = ChunkMap_Find(chunkMap, x, y, z, covering.Lod);
+        if (chunk) {
+            DynamicArrayPush(*outNeighbors, chunk);
+            return;
+        }
+        covering = (ChunkCell){ FloorDivide(covering.x, 2), FloorDivide(covering.y, 2), FloorDivide(covering.z, 2), covering.Lod + 1 };
+    }
+
+    // Faces come in opposite pairs so the opposite of a face only differs in the lowest bit
+    ChunkCell_FindChunksAtFace(chunkMap, adjacent, face ^ 1, outNeighbors);
+}
+
+typedef struct VisibilityStep {
+    Chunk* Chunk;
+    u8 EnteredFace; // The face of the chunk the search came in through
+    u8 Directions;  // Bit per BlockFace direction the search has moved in to get here
+} VisibilityStep;
+
+// Walks out from the camera's chunk through the faces that air connects, so chunks sealed off behind rock aren't drawn.
+// The search never turns back against a direction it has already moved in, which keeps it going away from the camera.
+// Returns FALSE if the camera isn't in a loaded chunk, then everything has to be drawn
+static b8 CollectVisibleChunks(ChunkMap* chunkMap, vec3 cameraPosition, u64 frame, VisibilityStep** steps, Chunk*** neighbors, Chunk*** outVisible) {
+    DynamicArrayLength(*outVisible) = 0;
+    DynamicArrayLength(*steps) = 0;
+
+    s64 cameraBlock[3] = { cast(s64) roundf(cameraPosition[0]), cast(s64) roundf(cameraPosition[1]), cast(s64) roundf(cameraPosition[2]) };
+    Chunk* cameraChunk = NULL;
+    for (u32 lod = 0; lod < CHUNK_LOD_COUNT && !cameraChunk; lod++) {
+        s64 x, y, z;
+        ChunkCell_GetChunkPosition(ChunkCell_FromBlock(cameraBlock[0], cameraBlock[1], cameraBlock[2], lod), &x, &y, &z);
+        cameraChunk = ChunkMap_Find(chunkMap, x, y, z, lod);
+    }
+    if (!cameraChunk) {
+        return FALSE;
+    }
+
+    // The camera can look out of every face of its own chunk
+    cameraChunk->VisibilityFrame = frame;
+    cameraChunk->VisibilityEnteredFaces = CHUNK_ALL_FACES;
+    DynamicArrayPush(*outVisible, cameraChunk);
+    for (BlockFace face = 0; face < BlockFace_Count; face++) {
+        DynamicArrayLength(*neighbors) = 0;
+        ChunkCell_FindFaceNeighbors(chunkMap, ChunkCell_FromChunk(cameraChunk), face, neighbors);
+        for (u64 i = 0; i < DynamicArrayLength(*neighbors); i++) {
+            VisibilityStep step = { (*neighbors)[i], face ^ 1, 1 << face };
+            DynamicArrayPush(*steps, step);
+        }
+    }
+
+    for (u64 stepIndex = 0; stepIndex < DynamicArrayLength(*steps); stepIndex++) {
+        VisibilityStep step = (*steps)[stepIndex];
+        Chunk* chunk = step.Chunk;
+
+        // A chunk is searched again for every new face it's entered through since those can lead out of different faces
+        if (chunk->VisibilityFrame != frame) {
+            chunk->VisibilityFrame = frame;
+            chunk->VisibilityEnteredFaces = 0;
+            DynamicArrayPush(*outVisible, chunk);
+        }
+        if (chunk->VisibilityEnteredFaces & (1 << step.EnteredFace)) {
+            continue;
+        }
+        chunk->VisibilityEnteredFaces |= 1 << step.EnteredFace;
+
+        for (BlockFace face = 0; face < BlockFace_Count; face++) {
+            if ((step.Directions & (1 << (face ^ 1))) || !(chunk->FaceConnections[step.EnteredFace] & (1 << face))) {
+                continue;
+            }
+
+            DynamicArrayLength(*neighbors) = 0;
+            ChunkCell_FindFaceNeighbors(chunkMap, ChunkCell_FromChunk(chunk), face, neighbors);
+            for (u64 i = 0; i < DynamicArrayLength(*neighbors); i++) {
+                VisibilityStep next = { (*neighbors)[i], face ^ 1, step.Directions | (1 << face) };
+                DynamicArrayPush(*steps, next);
+            }
+        }
+    }
+    return TRUE;
+}
+
+// Returns the full detail chunk that has the world block and the block's position in it, or NULL if it isn't loaded
+static Chunk* FindBlockChunk(ChunkMap* chunkMap, s64 x, s64 y, s64 z, s32 outLocal[3]) {
+    s64 chunkX, chunkY, chunkZ;
+    ChunkCell_GetChunkPosition(ChunkCell_FromBlock(x, y, z, 0), &chunkX, &chunkY, &chunkZ);
+    Chunk* chunk = ChunkMap_Find(chunkMap, chunkX, chunkY, chunkZ, 0);
+    if (chunk) {
+        outLocal[0] = cast(s32) (x - (chunkX - CHUNK_SIZE / 2));
+        outLocal[1] = cast(s32) (y - (chunkY - CHUNK_SIZE / 2));
+        outLocal[2] = cast(s32) (z - (chunkZ - CHUNK_SIZE / 2));
+    }
+    return chunk;
+}
+
+// Walks the blocks along the ray in order with a voxel DDA (Amanatides and Woo) until it hits a solid block in a loaded full detail chunk.
+// Every block the ray passes through is visited exactly once, outBefore gets the block the ray entered the hit block from
+static b8 RaycastBlock(ChunkMap* chunkMap, vec3 origin, vec3 direction, f32 maxDistance, s64 outHit[3], s64 outBefore[3]) {
+    // Blocks are centered on whole numbers, shifted by half a block their edges are on whole numbers instead
+    s64 block[3];
+    s64 step[3];
+    f32 nextEdge[3];    // The distance along the ray to the next block edge on each axis
+    f32 edgeSpacing[3]; // The distance along the ray between block edges on each axis
+    for (u32 axis = 0; axis < 3; axis++) {
+        f32 position = origin[axis] + 0.5f;
+        block[axis] = cast(s64) floorf(position);
+        if (direction[axis] > 0.0f) {
+            step[axis] = 1;
+            nextEdge[axis] = (cast(f32) (block[axis] + 1) - position) / direction[axis];
+            edgeSpacing[axis] = 1.0f / direction[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis] = -1;
+            nextEdge[axis] = (position - cast(f32) block[axis]) / -direction[axis];
+            edgeSpacing[axis] = -1.0f / direction[axis];
+        } else {
+            step[axis] = 0;
+            nextEdge[axis] = INFINITY;
+            edgeSpacing[axis] = INFINITY;
+        }
+    }
+
+    s64 previous[3] = { block[0], block[1], block[2] };
+    f32 distance = 0.0f;
+    while (distance <= maxDistance) {
+        s32 local[3];
+        Chunk* chunk = FindBlockChunk(chunkMap, block[0], block[1], block[2], local);
+        if (chunk && chunk->BlocksGenerated && chunk->Blocks[local[0] + (local[1] * chunk->Width) + (local[2] * chunk->Width * chunk->Height)] != BlockID_Air) {
+            memcpy(outHit, block, sizeof(block));
+            memcpy(outBefore, previous, sizeof(previous));
+            return TRUE;
+        }
+        memcpy(previous, block, sizeof(block));
+
+        // Cross the nearest block edge
+        u32 axis = 0;
+        if (nextEdge[1] < nextEdge[axis]) {
+            axis = 1;
+        }
+        if (nextEdge[2] < nextEdge[axis]) {
+            axis = 2;
+        }
+        distance = nextEdge[axis];
+        block[axis] += step[axis];
+        nextEdge[axis] += edgeSpacing[axis];
+    }
+    return FALSE;
+}
+
+// Sets a world block and patches the meshes of the chunk it's in and of the neighbors that have it in their padding.
+// Returns FALSE without changing anything if one of those chunks is busy with a worker so it can be tried again later
+static b8 SetWorldBlock(ChunkMap* chunkMap, s64 x, s64 y, s64 z, u16 block) {
+    Chunk* chunks[27];
+    s32 locals[27][3];
+    u32 chunkCount = 0;
+
+    ChunkCell cell = ChunkCell_FromBlock(x, y, z, 0);
+    for (s64 i = 0; i < 27; i++) {
+        ChunkCell neighborCell = { cell.x + (i % 3) - 1, cell.y + ((i / 3) % 3) - 1, cell.z + (i / 9) - 1, 0 };
+        s64 chunkX, chunkY, chunkZ;
+        ChunkCell_GetChunkPosition(neighborCell, &chunkX, &chunkY, &chunkZ);
+
+        s64 local[3] = { x - (chunkX - CHUNK_SIZE / 2), y - (chunkY - CHUNK_SIZE / 2), z - (chunkZ - CHUNK_SIZE / 2) };
+        if (local[0] < -1 || local[0] > CHUNK_SIZE || local[1] < -1 || local[1] > CHUNK_SIZE || local[2] < -1 || local[2] > CHUNK_SIZE) {
+            continue;
+        }
+
+        Chunk* chunk = ChunkMap_Find(chunkMap, chunkX, chunkY, chunkZ, 0);
+        if (!chunk) {
+            // The block's own chunk has to be loaded, the others just won't see the change until they're loaded
+            if (i == 13) {
+                return FALSE;
+            }
+            continue;
+        }
+        if (chunk->JobPending || chunk->UploadPending || chunk->References > 0 || !chunk->BlocksGenerated) {
+            return FALSE;
+        }
+
+        chunks[chunkCount] = chunk;
+        for (u32 axis = 0; axis < 3; axis++) {
+            locals[chunkCount][axis] = cast(s32) local[axis];
+        }
+        chunkCount++;
+    }
+
+    for (u32 i = 0; i < chunkCount; i++) {
+        Chunk_SetBlock(chunks[i], locals[i][0], locals[i][1], locals[i][2], block);
+        Chunk_UpdateMesh(chunks[i]);
+    }
+    return TRUE;
+}
+
+typedef struct MissingChunk {
+    ChunkCell Cell;
+    u8 LodSeams;
+    f32 Distance;
+} MissingChunk;
+
+static int MissingChunk_CompareDistance(const void* a, const void* b) {
+    f32 distanceA = (cast(const MissingChunk*) a)->Distance;
+    f32 distanceB = (cast(const MissingChunk*) b)->Distance;
+    return (distanceA > distanceB) - (distanceA < distanceB);
+}
+
+// A finished mesh waiting to be uploaded, the nearest ones go first
+typedef struct PendingUpload {
+    Chunk* Chunk;
+    f32 Distance;
+} PendingUpload;
+
+static int PendingUpload_CompareDistance(const void* a, const void* b) {
+    f32 distanceA = (cast(const PendingUpload*) a)->Distance;
+    f32 distanceB = (cast(const PendingUpload*) b)->Distance;
+    return (distanceA > distanceB) - (distanceA < distanceB);
+}
+
+// Most frames only add a few uploads, so they are inserted in order instead of sorting the whole queue again
+static void InsertPendingUpload(PendingUpload** pendingUploads, PendingUpload upload) {
+    u64 low = 0;
+    u64 high = DynamicArrayLength(*pendingUploads);
+    while (low < high) {
+        u64 middle = low + (high - low) / 2;
+        if ((*pendingUploads)[middle].Distance <= upload.Distance) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    DynamicArrayInsert(*pendingUploads, low, upload);
+}
+
+static void RemovePendingUpload(PendingUpload** pendingUploads, Chunk* chunk) {
+    for (u64 i = 0; i < DynamicArrayLength(*pendingUploads); i++) {
+        if ((*pendingUploads)[i].Chunk == chunk) {
+            DynamicArrayPopAt(*pendingUploads, i, NULL);
+            chunk->UploadPending = FALSE;
+            return;
+        }
+    }
+}
+
+static b8 ContainsChunk(Chunk** chunks, Chunk* chunk) {
+    for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
+        if (chunks[i] == chunk) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 int main(int argc, char** argv) {
     Clock_Init();
 
@@ -133,32 +628,53 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
+    GLState_Enable(GL_DEPTH_TEST);
 
-    glEnable(GL_BLEND);
+    GLState_Enable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glEnable(GL_CULL_FACE);
+    GLState_Enable(GL_CULL_FACE);
     glCullFace(GL_FRONT);
 
     static const char* VertexShaderSource =
         "#version 440 core\n"
         "\n"
-        "layout(location = 0) in vec4 a_Position;\n"
-        "layout(location = 1) in vec3 a_Normal;\n"
-        "layout(location = 2) in vec2 a_TexCoord;\n"
+        "layout(location = 0) in uvec2 a_Data;\n"
+        "layout(location = 1) in vec4 a_Chunk; // xyz is where the chunk starts in the world, w is the world size of its blocks\n"
         "\n"
         "layout(location = 0) out vec3 v_Normal;\n"
         "layout(location = 1) out vec2 v_TexCoord;\n"
+        "layout(location = 2) out float v_AmbientOcclusion;\n"
+        "layout(location = 3) flat out uint v_Block;\n"
         "\n"
-        "layout(location = 0) uniform mat4 u_Model;\n"
-        "layout(location = 1) uniform mat4 u_View;\n"
-        "layout(location = 2) uniform mat4 u_Projection;\n"
+        "layout(std140, binding = 0) uniform Camera {\n"
+        "   mat4 u_ViewProjection;\n"
+        "};\n"
+        "\n"
+        "// Indexed by BlockFace\n"
+        "const vec3 Normals[6] = vec3[6](\n"
+        "   vec3( 0.0,  1.0,  0.0),\n"
+        "   vec3( 0.0, -1.0,  0.0),\n"
+        "   vec3(-1.0,  0.0,  0.0),\n"
+        "   vec3( 1.0,  0.0,  0.0),\n"
+        "   vec3( 0.0,  0.0,  1.0),\n"
+        "   vec3( 0.0,  0.0, -1.0)\n"
+        ");\n"
+        "\n"
+        "// Indexed by the baked ambient occlusion, 0 is a corner with solid blocks on both sides\n"
+        "const float AmbientOcclusionCurve[4] = float[4](0.45, 0.65, 0.82, 1.0);\n"
         "\n"
         "void main() {\n"
-        "   v_Normal = (u_Model * vec4(a_Normal, 0.0)).xyz;\n"
-        "   v_TexCoord = a_TexCoord;\n"
-        "   gl_Position = u_Projection * u_View * u_Model * a_Position;\n"
+        "   vec3 position = vec3(a_Data.x & 0x7Fu, (a_Data.x >> 7) & 0x7Fu, (a_Data.x >> 14) & 0x7Fu);\n"
+        "   uint face = (a_Data.x >> 21) & 0x7u;\n"
+        "   vec2 texCoord = vec2(a_Data.y & 0x7Fu, (a_Data.y >> 7) & 0x7Fu);\n"
+        "   uint ambientOcclusion = (a_Data.y >> 14) & 0x3u;\n"
+        "\n"
+        "   v_Normal = Normals[face];\n"
+        "   v_TexCoord = texCoord;\n"
+        "   v_AmbientOcclusion = AmbientOcclusionCurve[ambientOcclusion];\n"
+        "   v_Block = a_Data.y >> 16;\n"
+        "   gl_Position = u_ViewProjection * vec4(a_Chunk.xyz + position * a_Chunk.w, 1.0);\n"
         "}\n";
 
     static const char* FragmentShaderSource =
@@ -168,17 +684,37 @@ int main(int argc, char** argv) {
         "\n"
         "layout(location = 0) in vec3 v_Normal;\n"
         "layout(location = 1) in vec2 v_TexCoord;\n"
+        "layout(location = 2) in float v_AmbientOcclusion;\n"
+        "layout(location = 3) flat in uint v_Block;\n"
+        "\n"
+        "layout(binding = 0) uniform sampler2DArray u_BlockTextures;\n"
         "\n"
         "void main() {\n"
-        "   vec3 color = vec3(0.8); // vec3(v_TexCoord, 0.0);\n"
-        "   o_Color = vec4(color * max(0.3, (dot(v_Normal, normalize(vec3(0.4, 1.0, -0.3))) + 1.0) * 0.5), 1.0f);\n"
+        "   vec3 color = texture(u_BlockTextures, vec3(v_TexCoord, float(v_Block))).rgb;\n"
+        "   o_Color = vec4(color * max(0.3, (dot(v_Normal, normalize(vec3(0.4, 1.0, -0.3))) + 1.0) * 0.5) * v_AmbientOcclusion, 1.0f);\n"
         "}\n";
 
-    GLuint shader = 0;
-    if (!CreateShader(VertexShaderSource, FragmentShaderSource, &shader)) {
-        printf("Unable to create shader!\n");
-        return -1;
-    }
+    // Draws the chunk boxes for the occlusion queries, only their depth test matters
+    static const char* OcclusionVertexShaderSource =
+        "#version 440 core\n"
+        "\n"
+        "layout(location = 0) in vec3 a_Corner; // 0 or 1 along each axis\n"
+        "layout(location = 1) in vec3 a_Min;\n"
+        "layout(location = 2) in vec3 a_Max;\n"
+        "\n"
+        "layout(std140, binding = 0) uniform Camera {\n"
+        "   mat4 u_ViewProjection;\n"
+        "};\n"
+        "\n"
+        "void main() {\n"
+        "   gl_Position = u_ViewProjection * vec4(mix(a_Min, a_Max, a_Corner), 1.0);\n"
+        "}\n";
+
+    static const char* OcclusionFragmentShaderSource =
+        "#version 440 core\n"
+        "\n"
+        "void main() {\n"
+        "}\n";
 
     static const char* TextVertexShaderSource =
         "#version 440 core\n"
@@ -204,12 +740,22 @@ int main(int argc, char** argv) {
         "   o_Color = vec4(v_TexCoord, 0.0, 1.0);\n"
         "}\n";
 
-    GLuint textShader = 0;
-    if (!CreateShader(TextVertexShaderSource, TextFragmentShaderSource, &textShader)) {
-        printf("Unable to create text shader!\n");
+    // Created together so they compile in parallel
+    ShaderSource shaderSources[] = {
+        { .Name = "Chunk", .VertexSource = VertexShaderSource, .FragmentSource = FragmentShaderSource },
+        { .Name = "Occlusion", .VertexSource = OcclusionVertexShaderSource, .FragmentSource = OcclusionFragmentShaderSource },
+        { .Name = "Text", .VertexSource = TextVertexShaderSource, .FragmentSource = TextFragmentShaderSource },
+    };
+    GLuint shaders[sizeof(shaderSources) / sizeof(shaderSources[0])] = {};
+    if (!CreateShaders(shaderSources, sizeof(shaderSources) / sizeof(shaderSources[0]), shaders)) {
+        printf("Unable to create shaders!\n");
         return -1;
     }
 
+    GLuint shader = shaders[0];
+    GLuint occlusionShader = shaders[1];
+    GLuint textShader = shaders[2];
+
     // TODO: Move this
 
     #define PSF1_MAGIC0     0x36
@@ -270,7 +816,34 @@ int main(int argc, char** argv) {
 
     Window_SetResizeCallback(window, WindowResizeCallback, &camera);
 
-    Chunk* chunks = DynamicArrayCreate(Chunk);
+    // The camera uniform block shared by every shader, filled once per frame
+    GLuint cameraUniformBuffer = 0;
+    glGenBuffers(1, &cameraUniformBuffer);
+    GLState_BindBufferBase(GL_UNIFORM_BUFFER, 0, cameraUniformBuffer);
+
+    Chunk** chunks = DynamicArrayCreate(Chunk*);
+    ChunkMap chunkMap;
+    ChunkMap_Create(&chunkMap);
+    // Reused every frame by the chunk streaming
+    ChunkCell* wantedCells = DynamicArrayCreate(ChunkCell);
+    MissingChunk* missingChunks = DynamicArrayCreate(MissingChunk);
+    // Chunks that have been unloaded but can't be destroyed yet because a worker is still using them
+    Chunk** retiredChunks = DynamicArrayCreate(Chunk*);
+    // Reused every frame by the visibility search
+    VisibilityStep* visibilitySteps = DynamicArrayCreate(VisibilityStep);
+    Chunk** visibilityNeighbors = DynamicArrayCreate(Chunk*);
+    Chunk** visibleChunks = DynamicArrayCreate(Chunk*);
+    PendingUpload* pendingUploads = DynamicArrayCreate(PendingUpload);
+
+    ChunkWorkers* chunkWorkers = ChunkWorkers_Create(0);
+
+    GPUTimer gpuTimer;
+    GPUTimer_Create(&gpuTimer);
+
+    // The only texture, so it stays bound to unit 0 for the chunk shader
+    BlockTextures* blockTextures = BlockTextures_Create("textures");
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, BlockTextures_GetTexture(blockTextures));
 
     Window_Show(window);
     Window_LockCursor(window);
@@ -279,10 +852,42 @@ int main(int argc, char** argv) {
     Clock_Start(&clock);
     Clock_Update(&clock);
     f64 lastTime = clock.Elapsed;
+    ChunkDrawStats drawStats = {};
+    u64 uploadedBytes = 0;
+    // The camera cell the upload queue was last sorted for, the order only needs redoing when the camera leaves it
+    ChunkCell uploadSortCell = {};
+    b8 uploadSortCellValid = FALSE;
+    u64 frame = 0;
     while (TRUE) {
         Clock_Update(&clock);
         f32 dt = cast(f32) (clock.Elapsed - lastTime);
-        printf("FPS: %f, Chunk Count: %llu                                                                \r", 1.0f / dt, DynamicArrayLength(chunks));
+
+        GPUTimer_BeginFrame(&gpuTimer);
+
+        // The average, median and 95th percentile GPU time of each pass over the last frames
+        char gpuTimes[512] = "";
+        u64 gpuTimesLength = 0;
+        for (u32 i = 0; i < gpuTimer.PassCount && gpuTimesLength < sizeof(gpuTimes); i++) {
+            GPUTimerStats passStats;
+            if (GPUTimer_GetStats(&gpuTimer, i, &passStats)) {
+                gpuTimesLength += snprintf(&gpuTimes[gpuTimesLength], sizeof(gpuTimes) - gpuTimesLength, "%s%s %.2f/%.2f/%.2f ms",
+                    gpuTimesLength > 0 ? ", " : "", gpuTimer.Passes[i].Name, passStats.Average, passStats.Median, passStats.Percentile95);
+            }
+        }
+
+        // The state changes of the last frame, and how many were skipped because the state was already set
+        GLStateCounters stateCounters = GLState_GetCounters();
+        GLState_ResetCounters();
+        u64 stateChanges = stateCounters.Programs.Changed + stateCounters.VertexArrays.Changed + stateCounters.Buffers.Changed + stateCounters.Capabilities.Changed;
+        u64 stateChangesSkipped = stateCounters.Programs.Skipped + stateCounters.VertexArrays.Skipped + stateCounters.Buffers.Skipped + stateCounters.Capabilities.Skipped;
+
+        // How many of the chunks in the frustum the occlusion queries culled
+        u64 frustumChunks = drawStats.Drawn + drawStats.Occluded;
+        f64 occludedPercent = frustumChunks > 0 ? cast(f64) drawStats.Occluded * 100.0 / cast(f64) frustumChunks : 0.0;
+
+        printf("FPS: %f, Chunk Count: %llu, Drawn Chunks: %llu, Occluded Chunks: %llu (%.1f%%), Draw Commands: %llu, Pending Chunks: %llu, Upload Queue: %llu (%.1f KB uploaded), GL State Changes: %llu (%llu skipped), GPU (avg/p50/p95): %s                    \r",
+            1.0f / dt, DynamicArrayLength(chunks), drawStats.Drawn, drawStats.Occluded, occludedPercent, drawStats.Commands, ChunkWorkers_GetPendingCount(chunkWorkers),
+            DynamicArrayLength(pendingUploads), cast(f64) uploadedBytes / 1024.0, stateChanges, stateChangesSkipped, gpuTimes);
 
         // Camera movement
         {
@@ -300,10 +905,7 @@ int main(int argc, char** argv) {
             }
 
             vec3 forward = {};
-            forward[0] = sinf(camera.Transform.Rotation[1] * cast(f32) (M_PI / 180.0)) * cosf(camera.Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
-            forward[1] = -sinf(camera.Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
-            forward[2] = cosf(camera.Transform.Rotation[1] * cast(f32) (M_PI / 180.0)) * cosf(camera.Transform.Rotation[0] * cast(f32) (M_PI / 180.0));
-            glm_vec3_normalize(forward);
+            GetCameraForward(&camera, forward);
 
             vec3 right = {};
             glm_vec3_cross((vec3){ 0.0f, 1.0f, 0.0f }, forward, right);
@@ -350,67 +952,263 @@ int main(int argc, char** argv) {
             }
         }
 
+        // Remesh everything with the new mode so the meshers can be compared on the same chunks
+        if (MeshModeChanged) {
+            MeshModeChanged = FALSE;
+
+            Clock meshClock = {};
+            Clock_Start(&meshClock);
+
+            // Chunks that are still with a worker or waiting to be uploaded get remeshed when they come up
+            u64 triangleCount = 0;
+            for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
+                if (chunks[i]->JobPending || chunks[i]->UploadPending) {
+                    continue;
+                }
+
+                Chunk* neighbors[CHUNK_NEIGHBOR_COUNT];
+                FindChunkNeighbors(&chunkMap, chunks[i], neighbors);
+                for (u32 j = 0; j < CHUNK_NEIGHBOR_COUNT; j++) {
+                    if (neighbors[j] && !neighbors[j]->BlocksGenerated) {
+                        neighbors[j] = NULL;
+                    }
+                }
+
+                chunks[i]->MeshMode = MeshMode;
+                Chunk_RecalculateMesh(chunks[i], neighbors);
+                triangleCount += (DynamicArrayLength(chunks[i]->Mesh.Vertices) / 4) * 2;
+            }
+
+            Clock_Update(&meshClock);
+            printf("\nMesh Mode: %s, Triangles: %llu, Meshing Time: %f ms\n",
+                MeshMode == ChunkMeshMode_Greedy ? "Greedy" : "Per Face", triangleCount, meshClock.Elapsed * 1000.0);
+        }
+
+        ChunkCell cameraChunkCell = ChunkCell_FromBlock(
+            cast(s64) roundf(camera.Transform.Position[0]),
+            cast(s64) roundf(camera.Transform.Position[1]),
+            cast(s64) roundf(camera.Transform.Position[2]),
+            0
+        );
+        if (!uploadSortCellValid || cameraChunkCell.x != uploadSortCell.x || cameraChunkCell.y != uploadSortCell.y || cameraChunkCell.z != uploadSortCell.z) {
+            for (u64 i = 0; i < DynamicArrayLength(pendingUploads); i++) {
+                pendingUploads[i].Distance = ChunkCell_GetDistance(ChunkCell_FromChunk(pendingUploads[i].Chunk), camera.Transform.Position);
+            }
+            qsort(pendingUploads, DynamicArrayLength(pendingUploads), sizeof(PendingUpload), PendingUpload_CompareDistance);
+            uploadSortCell = cameraChunkCell;
+            uploadSortCellValid = TRUE;
+        }
+
+        // Queue the chunks the workers have finished for upload, the only chunk work left on the main thread
+        {
+            Chunk* chunk = NULL;
+            while (ChunkWorkers_PopCompleted(chunkWorkers, &chunk)) {
+                if (ContainsChunk(retiredChunks, chunk)) {
+                    continue;
+                }
+
+                // An empty mesh uploads nothing, so it doesn't wait behind meshes that are over the budget
+                if (DynamicArrayLength(chunk->Mesh.Vertices) == 0 && chunk->MeshMode == MeshMode) {
+                    Chunk_UploadMesh(chunk);
+                    continue;
+                }
+
+                chunk->UploadPending = TRUE;
+                f32 distance = ChunkCell_GetDistance(ChunkCell_FromChunk(chunk), camera.Transform.Position);
+                InsertPendingUpload(&pendingUploads, (PendingUpload){ chunk, distance });
+            }
+        }
+
+        // Mesh sizes go from nothing to tens of KB, so uploads are limited by bytes instead of by chunks.
+        // The first one always goes so a mesh bigger than the whole budget still gets through
+        uploadedBytes = 0;
+        {
+            GPUTimer_BeginPass(&gpuTimer, "Uploads");
+            u64 uploadCount = 0;
+            for (; uploadCount < DynamicArrayLength(pendingUploads); uploadCount++) {
+                Chunk* chunk = pendingUploads[uploadCount].Chunk;
+                u64 meshSize = DynamicArraySize(chunk->Mesh.Vertices);
+                if (uploadedBytes > 0 && uploadedBytes + meshSize > ChunkUploadBudget) {
+                    break;
+                }
+                chunk->UploadPending = FALSE;
+
+                if (chunk->MeshMode != MeshMode) {
+                    Chunk* neighbors[CHUNK_NEIGHBOR_COUNT];
+                    FindChunkNeighbors(&chunkMap, chunk, neighbors);
+                    chunk->MeshMode = MeshMode;
+                    ChunkWorkers_Submit(chunkWorkers, chunk, neighbors);
+                    continue;
+                }
+
+                Chunk_UploadMesh(chunk);
+                uploadedBytes += meshSize;
+            }
+            GPUTimer_EndPass(&gpuTimer);
+
+            u64 remaining = DynamicArrayLength(pendingUploads) - uploadCount;
+            memmove(pendingUploads, &pendingUploads[uploadCount], remaining * sizeof(PendingUpload));
+            DynamicArrayLength(pendingUploads) = remaining;
+        }
+
+        // Edits that hit a busy chunk stay requested and are tried again next frame
+        if (BreakBlockRequested || PlaceBlockRequested) {
+            vec3 forward;
+            GetCameraForward(&camera, forward);
+
+            s64 hit[3], before[3];
+            if (RaycastBlock(&chunkMap, camera.Transform.Position, forward, 8.0f, hit, before)) {
+                Clock editClock = {};
+                Clock_Start(&editClock);
+
+                b8 edited = BreakBlockRequested ? SetWorldBlock(&chunkMap, hit[0], hit[1], hit[2], BlockID_Air)
+                                                : SetWorldBlock(&chunkMap, before[0], before[1], before[2], BlockID_Stone);
+                if (edited) {
+                    Clock_Update(&editClock);
+                    printf("\nBlock Edit: %f ms\n", editClock.Elapsed * 1000.0);
+                    BreakBlockRequested = FALSE;
+                    PlaceBlockRequested = FALSE;
+                }
+            } else {
+                BreakBlockRequested = FALSE;
+                PlaceBlockRequested = FALSE;
+            }
+        }
+
+        for (u64 i = 0; i < DynamicArrayLength(retiredChunks); i++) {
+            if (!retiredChunks[i]->JobPending && retiredChunks[i]->References == 0) {
+                Chunk_Destroy(retiredChunks[i]);
+                free(retiredChunks[i]);
+                DynamicArrayPopAt(retiredChunks, i, NULL);
+                i--;
+            }
+        }
+
         if (!ChunkLoadingDisabled) {
-            const u64 chunkSize = 8;
-            const s64 chunkRenderDistance = 5;
-            const u64 maxCreatedChunksPerFrame = 5;
-            u64 chunksCreated = 0;
-            for (s64 i = 0; i <= chunkRenderDistance; i++) {
-                for (s64 x = -i; x <= i; x++) {
-                    for (s64 y = -i; y <= i; y++) {
-                        for (s64 z = -i; z <= i; z++) {
-                            s64 posX = x * chunkSize + cast(s64) ((roundf(camera.Transform.Position[0] / chunkSize) * chunkSize));
-                            s64 posY = y * chunkSize + cast(s64) ((roundf(camera.Transform.Position[1] / chunkSize) * chunkSize));
-                            s64 posZ = z * chunkSize + cast(s64) ((roundf(camera.Transform.Position[2] / chunkSize) * chunkSize));
-
-                            b8 exists = FALSE;
-                            for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
-                                if (posX == chunks[i].Position.x && posY == chunks[i].Position.y && posZ == chunks[i].Position.z) {
-                                    exists = TRUE;
-                                    break;
-                                }
-                            }
-                            if (exists) {
-                                continue;
-                            }
-
-                            Chunk chunk;
-                            Chunk_Create(&chunk, posX, posY, posZ, chunkSize, chunkSize, chunkSize, shader);
-                            DynamicArrayPush(chunks, chunk);
-                            chunksCreated++;
-                            if (chunksCreated > maxCreatedChunksPerFrame) {
-                                goto End;
-                            }
+            // Creating a chunk only queues it for the workers so this is just to keep the queue short enough
+            // that the nearest chunks still get picked up first after the camera moves
+            const u64 maxCreatedChunksPerFrame = 32;
+            const u64 maxPendingChunks = 128;
+            const u64 maxChunksDestroyedPerFrame = 64;
+
+            // Split the biggest cells around the camera down to the ones that should have a chunk
+            DynamicArrayLength(wantedCells) = 0;
+            {
+                ChunkCell cameraCell = ChunkCell_FromBlock(
+                    cast(s64) roundf(camera.Transform.Position[0]),
+                    cast(s64) roundf(camera.Transform.Position[1]),
+                    cast(s64) roundf(camera.Transform.Position[2]),
+                    CHUNK_LOD_COUNT - 1
+                );
+                s64 rootDistance = cast(s64) ceilf(ChunkViewDistance / cast(f32) ChunkCell_GetSize(CHUNK_LOD_COUNT - 1));
+                for (s64 x = -rootDistance; x <= rootDistance; x++) {
+                    for (s64 y = -rootDistance; y <= rootDistance; y++) {
+                        for (s64 z = -rootDistance; z <= rootDistance; z++) {
+                            ChunkCell root = { cameraCell.x + x, cameraCell.y + y, cameraCell.z + z, CHUNK_LOD_COUNT - 1 };
+                            ChunkCell_CollectWanted(root, camera.Transform.Position, &wantedCells);
                         }
                     }
                 }
             }
-            End:
 
-            const u64 maxChunksDestroyedPerFrame = 10;
-            u64 chunksDestroyed = 0;
-            for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
-                if (_abs64(chunks[i].Position.x - cast(s64) ((roundf(camera.Transform.Position[0] / chunkSize) * chunkSize))) > chunkRenderDistance * cast(s64) chunkSize ||
-                    _abs64(chunks[i].Position.y - cast(s64) ((roundf(camera.Transform.Position[1] / chunkSize) * chunkSize))) > chunkRenderDistance * cast(s64) chunkSize ||
-                    _abs64(chunks[i].Position.z - cast(s64) ((roundf(camera.Transform.Position[2] / chunkSize) * chunkSize))) > chunkRenderDistance * cast(s64) chunkSize) {
-                    Chunk_Destroy(&chunks[i]);
-                    DynamicArrayPopAt(chunks, i, NULL);
-                    chunksDestroyed++;
-                    i--; // TODO: Is this safe?
+            DynamicArrayLength(missingChunks) = 0;
+            for (u64 i = 0; i < DynamicArrayLength(wantedCells); i++) {
+                ChunkCell cell = wantedCells[i];
+                s64 posX, posY, posZ;
+                ChunkCell_GetChunkPosition(cell, &posX, &posY, &posZ);
+                u8 lodSeams = ChunkCell_GetLodSeams(cell, camera.Transform.Position);
+
+                Chunk* chunk = ChunkMap_Find(&chunkMap, posX, posY, posZ, cell.Lod);
+                if (!chunk) {
+                    MissingChunk missing = {
+                        .Cell = cell,
+                        .LodSeams = lodSeams,
+                        .Distance = ChunkCell_GetDistance(cell, camera.Transform.Position),
+                    };
+                    DynamicArrayPush(missingChunks, missing);
+                } else if (chunk->LodSeams != lodSeams && !chunk->JobPending && !chunk->UploadPending) {
+                    // A neighbor changed Lod so the blocks across that face need to be culled differently
+                    Chunk* neighbors[CHUNK_NEIGHBOR_COUNT];
+                    FindChunkNeighbors(&chunkMap, chunk, neighbors);
+                    chunk->LodSeams = lodSeams;
+                    ChunkWorkers_Submit(chunkWorkers, chunk, neighbors);
                 }
+            }
 
-                if (chunksDestroyed > maxChunksDestroyedPerFrame) {
+            qsort(missingChunks, DynamicArrayLength(missingChunks), sizeof(MissingChunk), MissingChunk_CompareDistance);
+
+            u64 chunksCreated = 0;
+            for (u64 i = 0; i < DynamicArrayLength(missingChunks); i++) {
+                // Meshes waiting to be uploaded count too so a backed up upload queue slows the loading down
+                u64 pendingChunks = ChunkWorkers_GetPendingCount(chunkWorkers) + DynamicArrayLength(pendingUploads);
+                if (chunksCreated >= maxCreatedChunksPerFrame || pendingChunks >= maxPendingChunks) {
                     break;
                 }
+
+                ChunkCell cell = missingChunks[i].Cell;
+                s64 posX, posY, posZ;
+                ChunkCell_GetChunkPosition(cell, &posX, &posY, &posZ);
+
+                Chunk* chunk = malloc(sizeof(Chunk));
+                Chunk_Create(chunk, posX, posY, posZ, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE, cell.Lod, MeshMode);
+                chunk->LodSeams = missingChunks[i].LodSeams;
+
+                Chunk* neighbors[CHUNK_NEIGHBOR_COUNT];
+                FindChunkNeighbors(&chunkMap, chunk, neighbors);
+                ChunkWorkers_Submit(chunkWorkers, chunk, neighbors);
+                ChunkMap_Insert(&chunkMap, chunk);
+                DynamicArrayPush(chunks, chunk);
+                chunksCreated++;
+            }
+
+            u64 chunksDestroyed = 0;
+            for (u64 i = 0; i < DynamicArrayLength(chunks) && chunksDestroyed < maxChunksDestroyedPerFrame; i++) {
+                if (ChunkCell_IsWanted(ChunkCell_FromChunk(chunks[i]), camera.Transform.Position)) {
+                    continue;
+                }
+
+                ChunkMap_Remove(&chunkMap, chunks[i]);
+                Chunk_LeaveRegion(chunks[i]);
+                if (chunks[i]->UploadPending) {
+                    RemovePendingUpload(&pendingUploads, chunks[i]);
+                }
+                if (chunks[i]->JobPending || chunks[i]->References > 0) {
+                    DynamicArrayPush(retiredChunks, chunks[i]);
+                } else {
+                    Chunk_Destroy(chunks[i]);
+                    free(chunks[i]);
+                }
+                DynamicArrayPopAt(chunks, i, NULL);
+                chunksDestroyed++;
+                i--;
             }
         }
 
+        Chunk_FinishUploads();
+        BlockTextures_Update(blockTextures);
+
+        Camera_UpdateMatrices(&camera);
+        GLState_BindBuffer(GL_UNIFORM_BUFFER, cameraUniformBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(camera.ViewProjectionMatrix), camera.ViewProjectionMatrix, GL_STREAM_DRAW);
+
+        GPUTimer_BeginPass(&gpuTimer, "Clear");
         glClearColor(0.4f, 0.6f, 0.8f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        GPUTimer_EndPass(&gpuTimer);
+
+        // Wireframe would draw the boxes as lines too, which covers too little of the screen to test them
+        GLuint chunkOcclusionShader = OcclusionCullingDisabled || WireframeEnabled ? 0 : occlusionShader;
 
-        for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
-            Chunk_Draw(&chunks[i], &camera);
+        frame++;
+        b8 caveCulled = !CaveCullingDisabled && CollectVisibleChunks(&chunkMap, camera.Transform.Position, frame, &visibilitySteps, &visibilityNeighbors, &visibleChunks);
+
+        GPUTimer_BeginPass(&gpuTimer, "Terrain");
+        if (caveCulled) {
+            drawStats = Chunk_DrawChunks(visibleChunks, DynamicArrayLength(visibleChunks), shader, chunkOcclusionShader, &camera);
+        } else {
+            drawStats = Chunk_DrawChunks(chunks, DynamicArrayLength(chunks), shader, chunkOcclusionShader, &camera);
         }
+        GPUTimer_EndPass(&gpuTimer);
 
         Window_SwapBuffers(window);
 
@@ -426,10 +1224,31 @@ int main(int argc, char** argv) {
 
     Window_Hide(window);
 
+    ChunkWorkers_Destroy(chunkWorkers);
+
     for (u64 i = 0; i < DynamicArrayLength(chunks); i++) {
-        Chunk_Destroy(&chunks[i]);
+        Chunk_Destroy(chunks[i]);
+        free(chunks[i]);
+    }
+    DynamicArrayDestroy(chunks);
+    ChunkMap_Destroy(&chunkMap);
+    DynamicArrayDestroy(wantedCells);
+    DynamicArrayDestroy(missingChunks);
+    for (u64 i = 0; i < DynamicArrayLength(retiredChunks); i++) {
+        Chunk_Destroy(retiredChunks[i]);
+        free(retiredChunks[i]);
     }
-    glDeleteProgram(shader);
+    DynamicArrayDestroy(retiredChunks);
+    DynamicArrayDestroy(visibilitySteps);
+    DynamicArrayDestroy(visibilityNeighbors);
+    DynamicArrayDestroy(visibleChunks);
+    DynamicArrayDestroy(pendingUploads);
+    Chunk_DestroySharedResources();
+    GPUTimer_Destroy(&gpuTimer);
+    BlockTextures_Destroy(blockTextures);
+    GLState_DeleteBuffers(1, &cameraUniformBuffer);
+    GLState_DeleteProgram(shader);
+    GLState_DeleteProgram(occlusionShader);
 
     Window_Destroy(window);
 	return 0;
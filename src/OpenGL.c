@@ -2,6 +2,7 @@
 
 #define GL_FUNCTION(name, ret, ...) PFN_ ## name name = NULL;
 GL_FUNCTIONS
+GL_EXTENSION_FUNCTIONS
 #undef GL_FUNCTION
 
 #include <stdio.h>
@@ -20,9 +21,178 @@ static void* GetGLFunc(const char *name) {
     return func;
 }
 
+// Nothing is assumed about the state until it has been set once through the cache
+#define GLSTATE_UNKNOWN 0xFFFFFFFF
+
+static const GLenum GLState_BufferTargets[] = {
+    GL_ARRAY_BUFFER,
+    GL_ELEMENT_ARRAY_BUFFER,
+    GL_COPY_READ_BUFFER,
+    GL_COPY_WRITE_BUFFER,
+    GL_DRAW_INDIRECT_BUFFER,
+    GL_UNIFORM_BUFFER,
+};
+#define GLSTATE_BUFFER_TARGET_COUNT (sizeof(GLState_BufferTargets) / sizeof(GLState_BufferTargets[0]))
+
+static const GLenum GLState_Capabilities[] = {
+    GL_DEPTH_TEST,
+    GL_BLEND,
+    GL_CULL_FACE,
+};
+#define GLSTATE_CAPABILITY_COUNT (sizeof(GLState_Capabilities) / sizeof(GLState_Capabilities[0]))
+
+static GLuint GLState_Program;
+static GLuint GLState_VertexArray;
+static GLuint GLState_Buffers[GLSTATE_BUFFER_TARGET_COUNT];
+static u32 GLState_CapabilityStates[GLSTATE_CAPABILITY_COUNT]; // GL_TRUE, GL_FALSE or GLSTATE_UNKNOWN
+static GLStateCounters GLState_Counters;
+
+static void GLState_Reset() {
+    GLState_Program = GLSTATE_UNKNOWN;
+    GLState_VertexArray = GLSTATE_UNKNOWN;
+    for (u64 i = 0; i < GLSTATE_BUFFER_TARGET_COUNT; i++) {
+        GLState_Buffers[i] = GLSTATE_UNKNOWN;
+    }
+    for (u64 i = 0; i < GLSTATE_CAPABILITY_COUNT; i++) {
+        GLState_CapabilityStates[i] = GLSTATE_UNKNOWN;
+    }
+    GLState_Counters = (GLStateCounters){};
+}
+
 b8 InitializeOpenGLFunctions() {
     #define GL_FUNCTION(name, ret, ...) name = GetGLFunc(#name); if (!name) { printf("Unable to load OpenGL function: '" #name "'\n"); return FALSE; }
     GL_FUNCTIONS
     #undef GL_FUNCTION
+    #define GL_FUNCTION(name, ret, ...) name = GetGLFunc(#name);
+    GL_EXTENSION_FUNCTIONS
+    #undef GL_FUNCTION
+    GLState_Reset();
     return TRUE;
 }
+
+// Returns the cached binding of the target, or NULL if the target isn't cached
+static GLuint* GLState_GetBuffer(GLenum target) {
+    for (u64 i = 0; i < GLSTATE_BUFFER_TARGET_COUNT; i++) {
+        if (GLState_BufferTargets[i] == target) {
+            return &GLState_Buffers[i];
+        }
+    }
+    return NULL;
+}
+
+static u32* GLState_GetCapability(GLenum capability) {
+    for (u64 i = 0; i < GLSTATE_CAPABILITY_COUNT; i++) {
+        if (GLState_Capabilities[i] == capability) {
+            return &GLState_CapabilityStates[i];
+        }
+    }
+    return NULL;
+}
+
+void GLState_UseProgram(GLuint program) {
+    if (GLState_Program == program) {
+        GLState_Counters.Programs.Skipped++;
+        return;
+    }
+    glUseProgram(program);
+    GLState_Program = program;
+    GLState_Counters.Programs.Changed++;
+}
+
+void GLState_BindVertexArray(GLuint vertexArray) {
+    if (GLState_VertexArray == vertexArray) {
+        GLState_Counters.VertexArrays.Skipped++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    GLState_VertexArray = vertexArray;
+    GLState_Counters.VertexArrays.Changed++;
+
+    // The element buffer binding belongs to the vertex array
+    *GLState_GetBuffer(GL_ELEMENT_ARRAY_BUFFER) = GLSTATE_UNKNOWN;
+}
+
+void GLState_BindBuffer(GLenum target, GLuint buffer) {
+    GLuint* bound = GLState_GetBuffer(target);
+    if (bound && *bound == buffer) {
+        GLState_Counters.Buffers.Skipped++;
+        return;
+    }
+    glBindBuffer(target, buffer);
+    if (bound) {
+        *bound = buffer;
+    }
+    GLState_Counters.Buffers.Changed++;
+}
+
+void GLState_BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    // Binding an indexed target also binds the buffer to the generic target, the indexed bindings themselves aren't cached
+    glBindBufferBase(target, index, buffer);
+    GLuint* bound = GLState_GetBuffer(target);
+    if (bound) {
+        *bound = buffer;
+    }
+    GLState_Counters.Buffers.Changed++;
+}
+
+void GLState_Enable(GLenum capability) {
+    u32* state = GLState_GetCapability(capability);
+    if (state && *state == GL_TRUE) {
+        GLState_Counters.Capabilities.Skipped++;
+        return;
+    }
+    glEnable(capability);
+    if (state) {
+        *state = GL_TRUE;
+    }
+    GLState_Counters.Capabilities.Changed++;
+}
+
+void GLState_Disable(GLenum capability) {
+    u32* state = GLState_GetCapability(capability);
+    if (state && *state == GL_FALSE) {
+        GLState_Counters.Capabilities.Skipped++;
+        return;
+    }
+    glDisable(capability);
+    if (state) {
+        *state = GL_FALSE;
+    }
+    GLState_Counters.Capabilities.Changed++;
+}
+
+void GLState_DeleteProgram(GLuint program) {
+    // A program in use is only deleted once it isn't in use anymore, until then the binding is still valid
+    glDeleteProgram(program);
+}
+
+void GLState_DeleteVertexArrays(GLsizei n, const GLuint* vertexArrays) {
+    // Deleting the bound vertex array binds the default one
+    glDeleteVertexArrays(n, vertexArrays);
+    for (GLsizei i = 0; i < n; i++) {
+        if (vertexArrays[i] == GLState_VertexArray) {
+            GLState_VertexArray = 0;
+            *GLState_GetBuffer(GL_ELEMENT_ARRAY_BUFFER) = GLSTATE_UNKNOWN;
+        }
+    }
+}
+
+void GLState_DeleteBuffers(GLsizei n, const GLuint* buffers) {
+    // Deleting a bound buffer unbinds it
+    glDeleteBuffers(n, buffers);
+    for (GLsizei i = 0; i < n; i++) {
+        for (u64 j = 0; j < GLSTATE_BUFFER_TARGET_COUNT; j++) {
+            if (buffers[i] != 0 && GLState_Buffers[j] == buffers[i]) {
+                GLState_Buffers[j] = 0;
+            }
+        }
+    }
+}
+
+GLStateCounters GLState_GetCounters() {
+    return GLState_Counters;
+}
+
+void GLState_ResetCounters() {
+    GLState_Counters = (GLStateCounters){};
+}
@@ -47,6 +47,12 @@ typedef f64 GLclampd;
 
 #define GL_TRIANGLES 4
 
+#define GL_VENDOR 7936
+#define GL_RENDERER 7937
+#define GL_VERSION 7938
+#define GL_EXTENSIONS 7939
+#define GL_NUM_EXTENSIONS 33309
+
 #define GL_FRAGMENT_SHADER 35632
 #define GL_VERTEX_SHADER 35633
 
@@ -54,12 +60,50 @@ typedef f64 GLclampd;
 #define GL_LINK_STATUS 35714
 #define GL_INFO_LOG_LENGTH 35716
 
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 33367
+#define GL_PROGRAM_BINARY_LENGTH 34625
+
 #define GL_FLOAT 5126
 #define GL_UNSIGNED_INT 5125
+#define GL_UNSIGNED_BYTE 5121
+
+#define GL_TEXTURE0 33984
+#define GL_TEXTURE_2D_ARRAY 35866
+#define GL_RGBA 6408
+#define GL_RGBA8 32856
+
+#define GL_TEXTURE_MAG_FILTER 10240
+#define GL_TEXTURE_MIN_FILTER 10241
+#define GL_TEXTURE_WRAP_S 10242
+#define GL_TEXTURE_WRAP_T 10243
+#define GL_NEAREST 9728
+#define GL_NEAREST_MIPMAP_LINEAR 9986
+#define GL_REPEAT 10497
 
 #define GL_ARRAY_BUFFER 34962
 #define GL_ELEMENT_ARRAY_BUFFER 34963
-
+#define GL_COPY_READ_BUFFER 36662
+#define GL_COPY_WRITE_BUFFER 36663
+#define GL_DRAW_INDIRECT_BUFFER 36671
+#define GL_UNIFORM_BUFFER 35345
+
+#define GL_MAP_WRITE_BIT 2
+#define GL_MAP_PERSISTENT_BIT 64
+#define GL_MAP_COHERENT_BIT 128
+
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 37143
+#define GL_SYNC_FLUSH_COMMANDS_BIT 1
+#define GL_ALREADY_SIGNALED 37146
+#define GL_TIMEOUT_EXPIRED 37147
+#define GL_CONDITION_SATISFIED 37148
+#define GL_WAIT_FAILED 37149
+
+#define GL_ANY_SAMPLES_PASSED 35887
+#define GL_QUERY_RESULT 34918
+#define GL_QUERY_RESULT_AVAILABLE 34919
+#define GL_TIMESTAMP 36392
+
+#define GL_STREAM_DRAW 35040
 #define GL_STATIC_DRAW 35044
 #define GL_DYNAMIC_DRAW 35048
 
@@ -72,9 +116,18 @@ typedef f64 GLclampd;
     GL_FUNCTION(glBlendFunc, void, GLenum sfactor, GLenum dfactor) \
     GL_FUNCTION(glCullFace, void, GLenum mode) \
     \
+    GL_FUNCTION(glDepthMask, void, GLboolean flag) \
+    GL_FUNCTION(glColorMask, void, GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) \
+    \
     GL_FUNCTION(glPolygonMode, void, GLenum face, GLenum mode) \
     \
+    GL_FUNCTION(glGetString, const GLubyte*, GLenum name) \
+    GL_FUNCTION(glGetStringi, const GLubyte*, GLenum name, GLuint index) \
+    GL_FUNCTION(glGetIntegerv, void, GLenum pname, GLint* data) \
+    \
     GL_FUNCTION(glDrawElements, void, GLenum mode, GLsizei count, GLenum type, const void* indices) \
+    GL_FUNCTION(glDrawElementsInstancedBaseInstance, void, GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLuint baseinstance) \
+    GL_FUNCTION(glMultiDrawElementsIndirect, void, GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) \
     \
     GL_FUNCTION(glViewport, void, GLint x, GLint y, GLsizei width, GLsizei height) \
     \
@@ -93,26 +146,93 @@ typedef f64 GLclampd;
     GL_FUNCTION(glDetachShader, void, GLuint program, GLuint shader) \
     GL_FUNCTION(glUseProgram, void, GLuint program) \
     GL_FUNCTION(glDeleteProgram, void, GLuint program) \
+    GL_FUNCTION(glProgramParameteri, void, GLuint program, GLenum pname, GLint value) \
+    GL_FUNCTION(glGetProgramBinary, void, GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) \
+    GL_FUNCTION(glProgramBinary, void, GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) \
     \
     GL_FUNCTION(glUniformMatrix4fv, void, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) \
     \
     GL_FUNCTION(glGenVertexArrays, void, GLsizei n, GLuint* arrays) \
     GL_FUNCTION(glBindVertexArray, void, GLuint array) \
     GL_FUNCTION(glVertexAttribPointer, void, GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) \
+    GL_FUNCTION(glVertexAttribIPointer, void, GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) \
     GL_FUNCTION(glEnableVertexAttribArray, void, GLuint index) \
+    GL_FUNCTION(glVertexAttribDivisor, void, GLuint index, GLuint divisor) \
     GL_FUNCTION(glDeleteVertexArrays, void, GLsizei n, const GLuint* arrays) \
     \
+    GL_FUNCTION(glGenTextures, void, GLsizei n, GLuint* textures) \
+    GL_FUNCTION(glActiveTexture, void, GLenum texture) \
+    GL_FUNCTION(glBindTexture, void, GLenum target, GLuint texture) \
+    GL_FUNCTION(glTexParameteri, void, GLenum target, GLenum pname, GLint param) \
+    GL_FUNCTION(glTexStorage3D, void, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) \
+    GL_FUNCTION(glTexSubImage3D, void, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels) \
+    GL_FUNCTION(glGenerateMipmap, void, GLenum target) \
+    GL_FUNCTION(glDeleteTextures, void, GLsizei n, const GLuint* textures) \
+    \
     GL_FUNCTION(glGenBuffers, void, GLsizei n, GLuint* buffers) \
     GL_FUNCTION(glBindBuffer, void, GLenum target, GLuint buffer) \
+    GL_FUNCTION(glBindBufferBase, void, GLenum target, GLuint index, GLuint buffer) \
     GL_FUNCTION(glBufferData, void, GLenum target, GLsizeiptr size, const void* data, GLenum usage) \
-    GL_FUNCTION(glDeleteBuffers, void, GLsizei n, const GLuint* buffers)
+    GL_FUNCTION(glBufferSubData, void, GLenum target, GLintptr offset, GLsizeiptr size, const void* data) \
+    GL_FUNCTION(glCopyBufferSubData, void, GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) \
+    GL_FUNCTION(glBufferStorage, void, GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) \
+    GL_FUNCTION(glMapBufferRange, void*, GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) \
+    GL_FUNCTION(glUnmapBuffer, GLboolean, GLenum target) \
+    GL_FUNCTION(glDeleteBuffers, void, GLsizei n, const GLuint* buffers) \
+    \
+    GL_FUNCTION(glFenceSync, GLsync, GLenum condition, GLbitfield flags) \
+    GL_FUNCTION(glClientWaitSync, GLenum, GLsync sync, GLbitfield flags, GLuint64 timeout) \
+    GL_FUNCTION(glDeleteSync, void, GLsync sync) \
+    \
+    GL_FUNCTION(glGenQueries, void, GLsizei n, GLuint* ids) \
+    GL_FUNCTION(glBeginQuery, void, GLenum target, GLuint id) \
+    GL_FUNCTION(glEndQuery, void, GLenum target) \
+    GL_FUNCTION(glGetQueryObjectuiv, void, GLuint id, GLenum pname, GLuint* params) \
+    GL_FUNCTION(glGetQueryObjectui64v, void, GLuint id, GLenum pname, GLuint64* params) \
+    GL_FUNCTION(glQueryCounter, void, GLuint id, GLenum target) \
+    GL_FUNCTION(glDeleteQueries, void, GLsizei n, const GLuint* ids)
+
+// Extension functions, these are NULL when the driver doesn't support them
+#define GL_EXTENSION_FUNCTIONS \
+    GL_FUNCTION(glMaxShaderCompilerThreadsKHR, void, GLuint count) \
+    GL_FUNCTION(glMaxShaderCompilerThreadsARB, void, GLuint count)
 
 #define GL_FUNCTION(name, ret, ...) typedef ret (_cdecl *PFN_ ## name)(__VA_ARGS__);
 GL_FUNCTIONS
+GL_EXTENSION_FUNCTIONS
 #undef GL_FUNCTION
 
 #define GL_FUNCTION(name, ret, ...) extern PFN_ ## name name;
 GL_FUNCTIONS
+GL_EXTENSION_FUNCTIONS
 #undef GL_FUNCTION
 
 b8 InitializeOpenGLFunctions();
+
+// A cache of the bound program, vertex array, buffers and capabilities so binding what is already bound is skipped.
+// Every bind and delete of those has to go through these for the cache to stay correct
+void GLState_UseProgram(GLuint program);
+void GLState_BindVertexArray(GLuint vertexArray);
+void GLState_BindBuffer(GLenum target, GLuint buffer);
+void GLState_BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void GLState_Enable(GLenum capability);
+void GLState_Disable(GLenum capability);
+void GLState_DeleteProgram(GLuint program);
+void GLState_DeleteVertexArrays(GLsizei n, const GLuint* vertexArrays);
+void GLState_DeleteBuffers(GLsizei n, const GLuint* buffers);
+
+typedef struct GLStateCounter {
+    u64 Changed;
+    u64 Skipped;
+} GLStateCounter;
+
+typedef struct GLStateCounters {
+    GLStateCounter Programs;
+    GLStateCounter VertexArrays;
+    GLStateCounter Buffers;
+    GLStateCounter Capabilities;
+} GLStateCounters;
+
+// Counted since the last reset
+GLStateCounters GLState_GetCounters();
+void GLState_ResetCounters();
@@ -3,92 +3,270 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <Windows.h>
 
-b8 CreateShader(const char* vertexSource, const char* fragmentSource, GLuint* outShader) {
-    *outShader = 0;
+#define SHADER_CACHE_DIRECTORY "ShaderCache"
+#define SHADER_CACHE_MAGIC 0x48435353 // "SSCH"
+#define SHADER_CACHE_MAX_BINARY_LENGTH (64 * 1024 * 1024)
 
-    GLuint vertexShader = 0;
-    {
-        GLint vertexSourceLength = strlen(vertexSource);
-        vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexSource, &vertexSourceLength);
-        glCompileShader(vertexShader);
+// Written in front of the program binary in each cache file
+typedef struct ShaderCacheHeader {
+    u32 Magic;
+    GLenum BinaryFormat;
+    u64 Hash;
+    u64 BinaryLength;
+} ShaderCacheHeader;
 
-        GLint compiled = FALSE;
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &compiled);
-        if (!compiled) {
-            GLint maxLength = 0;
-            glGetShaderiv(vertexShader, GL_INFO_LOG_LENGTH, &maxLength);
+typedef struct ShaderBuild {
+    GLuint Program;
+    GLuint VertexShader;
+    GLuint FragmentShader;
+    u64 Hash;
+    b8 Cached;
+} ShaderBuild;
 
-            GLchar* infoLog = malloc(maxLength);
+// FNV-1a, the terminator is hashed too so the strings can't run into each other
+static u64 Shader_Hash(u64 hash, const char* string) {
+    for (u64 i = 0;; i++) {
+        hash ^= cast(u8) string[i];
+        hash *= 1099511628211ull;
+        if (string[i] == '\0') {
+            return hash;
+        }
+    }
+}
 
-            GLsizei length = 0;
-            glGetShaderInfoLog(vertexShader, maxLength, &length, infoLog);
+static void Shader_GetCachePath(u64 hash, char* path, u64 pathSize) {
+    snprintf(path, pathSize, SHADER_CACHE_DIRECTORY "/%016llx.bin", hash);
+}
 
-            printf("Vertex Shader Compilation Failed: %.*s\n", length, infoLog);
-            
-            free(infoLog);
+// Returns FALSE if there is no cache file for the hash, or the driver doesn't accept the binary in it anymore.
+// A file that can't be used is deleted so later launches don't read it again before compiling
+static b8 Shader_LoadBinary(GLuint program, u64 hash) {
+    char path[64];
+    Shader_GetCachePath(hash, path, sizeof(path));
 
-            return FALSE;
-        }
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return FALSE;
     }
 
-    GLuint fragmentShader = 0;
-    {
-        GLint fragmentSourceLength = strlen(fragmentSource);
+    // The length in the header has to match what is left of the file, a truncated or corrupt file is stale
+    s64 fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        fileSize = ftell(file);
+    }
+    rewind(file);
 
-        fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentSource, &fragmentSourceLength);
-        glCompileShader(fragmentShader);
+    b8 loaded = FALSE;
+    ShaderCacheHeader header = {};
+    if (fileSize >= cast(s64) sizeof(header) && fread(&header, sizeof(header), 1, file) == 1 &&
+        header.Magic == SHADER_CACHE_MAGIC && header.Hash == hash &&
+        header.BinaryLength > 0 && header.BinaryLength <= SHADER_CACHE_MAX_BINARY_LENGTH &&
+        header.BinaryLength == cast(u64) fileSize - sizeof(header)) {
+        void* binary = malloc(header.BinaryLength);
+        if (binary && fread(binary, header.BinaryLength, 1, file) == 1) {
+            glProgramBinary(program, header.BinaryFormat, binary, cast(GLsizei) header.BinaryLength);
 
-        GLint compiled = FALSE;
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &compiled);
-        if (!compiled) {
-            GLint maxLength = 0;
-            glGetShaderiv(fragmentShader, GL_INFO_LOG_LENGTH, &maxLength);
+            GLint linked = FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            loaded = linked;
+        }
+        free(binary);
+    }
+
+    fclose(file);
+    if (!loaded) {
+        remove(path);
+    }
+    return loaded;
+}
 
-            GLchar* infoLog = malloc(maxLength);
+static void Shader_SaveBinary(GLuint program, u64 hash) {
+    GLint binaryLength = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0) {
+        return; // The driver has no binary formats
+    }
+
+    ShaderCacheHeader header = {};
+    header.Magic = SHADER_CACHE_MAGIC;
+    header.Hash = hash;
 
-            GLsizei length = 0;
-            glGetShaderInfoLog(fragmentShader, maxLength, &length, infoLog);
+    void* binary = malloc(binaryLength);
+    if (!binary) {
+        return;
+    }
+    GLsizei length = 0;
+    glGetProgramBinary(program, binaryLength, &length, &header.BinaryFormat, binary);
+    header.BinaryLength = length;
 
-            printf("Fragment Shader Compilation Failed: %.*s\n", length, infoLog);
+    CreateDirectoryA(SHADER_CACHE_DIRECTORY, NULL);
 
-            free(infoLog);
+    char path[64];
+    Shader_GetCachePath(hash, path, sizeof(path));
 
-            return FALSE;
-        }
+    FILE* file = fopen(path, "wb");
+    if (file) {
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(binary, length, 1, file);
+        fclose(file);
+    } else {
+        printf("Unable to write shader cache file: '%s'\n", path);
     }
 
-    GLuint shader = glCreateProgram();
-    glAttachShader(shader, vertexShader);
-    glAttachShader(shader, fragmentShader);
-    glLinkProgram(shader);
+    free(binary);
+}
+
+static GLuint Shader_StartCompile(GLenum type, const char* source) {
+    GLint sourceLength = strlen(source);
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, &sourceLength);
+    glCompileShader(shader);
+    return shader;
+}
+
+static b8 Shader_CheckCompiled(GLuint shader, const char* name, const char* stage) {
+    GLint compiled = FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        GLint maxLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+
+        GLchar* infoLog = malloc(maxLength);
+
+        GLsizei length = 0;
+        glGetShaderInfoLog(shader, maxLength, &length, infoLog);
+
+        printf("%s %s Shader Compilation Failed: %.*s\n", name, stage, length, infoLog);
+
+        free(infoLog);
 
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static b8 Shader_CheckLinked(GLuint program, const char* name) {
     GLint linked = FALSE;
-    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (!linked) {
         GLint maxLength = 0;
-        glGetProgramiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
 
         GLchar* infoLog = malloc(maxLength);
 
         GLsizei length = 0;
-        glGetProgramInfoLog(shader, maxLength, &length, infoLog);
+        glGetProgramInfoLog(program, maxLength, &length, infoLog);
 
-        printf("Shader Linking Failed: %.*s\n", length, infoLog);
+        printf("%s Shader Linking Failed: %.*s\n", name, length, infoLog);
 
         free(infoLog);
 
         return FALSE;
     }
+    return TRUE;
+}
 
-    glDetachShader(shader, vertexShader);
-    glDeleteShader(vertexShader);
+// A driver can hand out an extension's functions without supporting it, only the extension list says if they can be called
+static b8 Shader_HasExtension(const char* name) {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        const char* extension = cast(const char*) glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
 
-    glDetachShader(shader, fragmentShader);
-    glDeleteShader(fragmentShader);
+b8 CreateShaders(const ShaderSource* sources, u64 count, GLuint* outShaders) {
+    // Lets the driver compile and link on its own threads, the status queries below are what wait for it
+    if (glMaxShaderCompilerThreadsKHR && Shader_HasExtension("GL_KHR_parallel_shader_compile")) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    } else if (glMaxShaderCompilerThreadsARB && Shader_HasExtension("GL_ARB_parallel_shader_compile")) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
 
-    *outShader = shader;
-    return TRUE;
+    // A binary is only valid for the driver that made it
+    u64 driverHash = 14695981039346656037ull;
+    driverHash = Shader_Hash(driverHash, cast(const char*) glGetString(GL_VENDOR));
+    driverHash = Shader_Hash(driverHash, cast(const char*) glGetString(GL_RENDERER));
+    driverHash = Shader_Hash(driverHash, cast(const char*) glGetString(GL_VERSION));
+
+    ShaderBuild* builds = calloc(count, sizeof(ShaderBuild));
+
+    // Start every compile before waiting on any of them
+    for (u64 i = 0; i < count; i++) {
+        ShaderBuild* build = &builds[i];
+        build->Hash = Shader_Hash(Shader_Hash(driverHash, sources[i].VertexSource), sources[i].FragmentSource);
+
+        build->Program = glCreateProgram();
+        if (Shader_LoadBinary(build->Program, build->Hash)) {
+            build->Cached = TRUE;
+            continue;
+        }
+
+        // The program isn't reused after a rejected binary, so the failed load leaves nothing behind
+        GLState_DeleteProgram(build->Program);
+        build->Program = glCreateProgram();
+        glProgramParameteri(build->Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        build->VertexShader = Shader_StartCompile(GL_VERTEX_SHADER, sources[i].VertexSource);
+        build->FragmentShader = Shader_StartCompile(GL_FRAGMENT_SHADER, sources[i].FragmentSource);
+    }
+
+    for (u64 i = 0; i < count; i++) {
+        ShaderBuild* build = &builds[i];
+        if (!build->Cached) {
+            glAttachShader(build->Program, build->VertexShader);
+            glAttachShader(build->Program, build->FragmentShader);
+            glLinkProgram(build->Program);
+        }
+    }
+
+    b8 success = TRUE;
+    for (u64 i = 0; i < count; i++) {
+        ShaderBuild* build = &builds[i];
+        if (build->Cached) {
+            continue;
+        }
+
+        if (success) {
+            success = Shader_CheckCompiled(build->VertexShader, sources[i].Name, "Vertex") &&
+                      Shader_CheckCompiled(build->FragmentShader, sources[i].Name, "Fragment") &&
+                      Shader_CheckLinked(build->Program, sources[i].Name);
+            if (success) {
+                Shader_SaveBinary(build->Program, build->Hash);
+            }
+        }
+
+        glDetachShader(build->Program, build->VertexShader);
+        glDeleteShader(build->VertexShader);
+
+        glDetachShader(build->Program, build->FragmentShader);
+        glDeleteShader(build->FragmentShader);
+    }
+
+    for (u64 i = 0; i < count; i++) {
+        if (success) {
+            outShaders[i] = builds[i].Program;
+        } else {
+            GLState_DeleteProgram(builds[i].Program);
+            outShaders[i] = 0;
+        }
+    }
+
+    free(builds);
+    return success;
+}
+
+b8 CreateShader(const char* vertexSource, const char* fragmentSource, GLuint* outShader) {
+    ShaderSource source = {
+        .Name = "Unnamed",
+        .VertexSource = vertexSource,
+        .FragmentSource = fragmentSource,
+    };
+    return CreateShaders(&source, 1, outShader);
 }
@@ -3,4 +3,13 @@
 #include "Typedefs.h"
 #include "OpenGL.h"
 
+typedef struct ShaderSource {
+    const char* Name; // Only used in error messages
+    const char* VertexSource;
+    const char* FragmentSource;
+} ShaderSource;
+
+// Creates all the programs at once so the driver can compile them in parallel.
+// Programs are loaded from the binary cache on disk when the source and driver haven't changed since they were saved
+b8 CreateShaders(const ShaderSource* sources, u64 count, GLuint* outShaders);
 b8 CreateShader(const char* vertexSource, const char* fragmentSource, GLuint* outShader);
@@ -0,0 +1,89 @@
+#include "UploadRing.h"
+#include "DynamicArray.h"
+
+void UploadRing_Create(UploadRing* ring, u64 size) {
+    *ring = (UploadRing){
+        .Size = size,
+        .Fences = DynamicArrayCreate(UploadRingFence),
+    };
+
+    const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &ring->Buffer);
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, ring->Buffer);
+    glBufferStorage(GL_COPY_READ_BUFFER, size, NULL, Flags);
+    ring->Mapped = glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, Flags);
+    ASSERT(ring->Mapped);
+}
+
+void UploadRing_Destroy(UploadRing* ring) {
+    for (u64 i = 0; i < DynamicArrayLength(ring->Fences); i++) {
+        glDeleteSync(ring->Fences[i].Sync);
+    }
+    DynamicArrayDestroy(ring->Fences);
+
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, ring->Buffer);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    GLState_DeleteBuffers(1, &ring->Buffer);
+    *ring = (UploadRing){};
+}
+
+static void UploadRing_WaitForOldestFence(UploadRing* ring) {
+    UploadRingFence fence = ring->Fences[0];
+    DynamicArrayPopAt(ring->Fences, 0, NULL);
+
+    // Only the first wait needs to flush, after that the fence is on its way to the GPU
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (TRUE) {
+        GLenum result = glClientWaitSync(fence.Sync, flags, 1000000000);
+        ASSERT(result != GL_WAIT_FAILED);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        flags = 0;
+    }
+
+    glDeleteSync(fence.Sync);
+    ring->Completed = fence.End;
+}
+
+void* UploadRing_Allocate(UploadRing* ring, u64 size, u64* outOffset) {
+    ASSERT(size <= ring->Size);
+
+    // Allocations don't wrap around the end of the buffer, the rest of it is skipped instead
+    u64 start = ring->Head;
+    if ((start % ring->Size) + size > ring->Size) {
+        start += ring->Size - (start % ring->Size);
+    }
+    u64 end = start + size;
+
+    // The last use of this space was a lap of the ring ago, unless that part of the last lap was skipped or never reached
+    u64 required = end > ring->Size ? end - ring->Size : 0;
+    if (required > ring->Head) {
+        required = ring->Head;
+    }
+
+    while (ring->Completed < required) {
+        if (DynamicArrayLength(ring->Fences) == 0) {
+            // A single frame has used up the whole ring
+            UploadRing_Fence(ring);
+        }
+        UploadRing_WaitForOldestFence(ring);
+    }
+
+    ring->Head = end;
+    *outOffset = start % ring->Size;
+    return &ring->Mapped[*outOffset];
+}
+
+void UploadRing_Fence(UploadRing* ring) {
+    if (ring->Head == ring->FencedHead) {
+        return;
+    }
+
+    UploadRingFence fence = {
+        .Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+        .End = ring->Head,
+    };
+    DynamicArrayPush(ring->Fences, fence);
+    ring->FencedHead = ring->Head;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "OpenGL.h"
+
+// Writes before End are done with once Sync is signaled
+typedef struct UploadRingFence {
+    GLsync Sync;
+    u64 End;
+} UploadRingFence;
+
+// A persistently and coherently mapped buffer that uploads are written into directly and then copied from on the GPU.
+// Positions only ever go up, the position in the buffer is the position modulo Size
+typedef struct UploadRing {
+    GLuint Buffer;
+    u8* Mapped;
+    u64 Size;
+    u64 Head;       // Where the next allocation starts
+    u64 FencedHead; // Head when the last fence was inserted
+    u64 Completed;  // Everything before this is known to be done with by the GPU
+    UploadRingFence* Fences; // Oldest first
+} UploadRing;
+
+void UploadRing_Create(UploadRing* ring, u64 size);
+void UploadRing_Destroy(UploadRing* ring);
+
+// Returns where to write size bytes and their offset in ring->Buffer, waiting for the GPU if that part of the ring is still in use.
+// The space has to be used by GL commands before the next UploadRing_Fence
+void* UploadRing_Allocate(UploadRing* ring, u64 size, u64* outOffset);
+
+// Fences everything allocated since the last fence, call after the commands reading it have been issued
+void UploadRing_Fence(UploadRing* ring);
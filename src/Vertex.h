@@ -1,10 +1,25 @@
 #pragma once
 
 #include "Typedefs.h"
-#include <cglm/cglm.h>
 
+// Packed chunk vertex, decoded in the chunk vertex shader
+//   Data0: bits 0-20 chunk local position (7 bits per axis), bits 21-23 block face
+//   Data1: bits 0-13 texture coordinate (7 bits per axis, in blocks), bits 14-15 ambient occlusion (0 is fully occluded, 3 is open), bits 16-31 block id
 typedef struct Vertex {
-    vec3 Position;
-    vec3 Normal;
-    vec2 TexCoord;
+    u32 Data0;
+    u32 Data1;
 } Vertex;
+
+#define VERTEX_POSITION_BITS 7
+#define VERTEX_POSITION_MAX ((1 << VERTEX_POSITION_BITS) - 1)
+
+static inline Vertex Vertex_Pack(u32 x, u32 y, u32 z, u32 face, u32 u, u32 v, u32 ao, u16 block) {
+    ASSERT(x <= VERTEX_POSITION_MAX && y <= VERTEX_POSITION_MAX && z <= VERTEX_POSITION_MAX);
+    ASSERT(u <= VERTEX_POSITION_MAX && v <= VERTEX_POSITION_MAX);
+    ASSERT(face < 8);
+    ASSERT(ao < 4);
+    return (Vertex){
+        .Data0 = x | (y << 7) | (z << 14) | (face << 21),
+        .Data1 = u | (v << 7) | (ao << 14) | (cast(u32) block << 16),
+    };
+}
@@ -0,0 +1,158 @@
+#include "VertexArena.h"
+#include "DynamicArray.h"
+#include "Vertex.h"
+
+#include <string.h>
+
+static void VertexArena_InsertFreeBlock(VertexArena* arena, u32 offset, u32 count) {
+    u64 blockCount = DynamicArrayLength(arena->FreeBlocks);
+
+    // Find the first block after the new one
+    u64 low = 0;
+    u64 high = blockCount;
+    while (low < high) {
+        u64 middle = (low + high) / 2;
+        if (arena->FreeBlocks[middle].Offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    u64 index = low;
+
+    b8 mergesPrevious = index > 0 && arena->FreeBlocks[index - 1].Offset + arena->FreeBlocks[index - 1].Count == offset;
+    b8 mergesNext = index < blockCount && offset + count == arena->FreeBlocks[index].Offset;
+    if (mergesPrevious && mergesNext) {
+        arena->FreeBlocks[index - 1].Count += count + arena->FreeBlocks[index].Count;
+        DynamicArrayPopAt(arena->FreeBlocks, index, NULL);
+    } else if (mergesPrevious) {
+        arena->FreeBlocks[index - 1].Count += count;
+    } else if (mergesNext) {
+        arena->FreeBlocks[index].Offset = offset;
+        arena->FreeBlocks[index].Count += count;
+    } else {
+        DynamicArrayInsert(arena->FreeBlocks, index, ((VertexArenaBlock){ offset, count }));
+    }
+}
+
+static void VertexArena_Grow(VertexArena* arena) {
+    u32 capacity = arena->Capacity * 2;
+
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, cast(u64) capacity * sizeof(Vertex), NULL, 0);
+
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, arena->Buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, cast(u64) arena->Capacity * sizeof(Vertex));
+    GLState_DeleteBuffers(1, &arena->Buffer);
+
+    // The new space merges with a free block at the end of the old buffer
+    VertexArena_InsertFreeBlock(arena, arena->Capacity, capacity - arena->Capacity);
+    arena->Buffer = buffer;
+    arena->Capacity = capacity;
+}
+
+void VertexArena_Create(VertexArena* arena, u32 capacity) {
+    ASSERT(capacity > 0);
+    *arena = (VertexArena){
+        .Capacity = capacity,
+        .FreeBlocks = DynamicArrayCreate(VertexArenaBlock),
+        .RetiredBlocks = DynamicArrayCreate(VertexArenaBlock),
+        .Fences = DynamicArrayCreate(VertexArenaFence),
+    };
+    DynamicArrayPush(arena->FreeBlocks, ((VertexArenaBlock){ 0, capacity }));
+
+    glGenBuffers(1, &arena->Buffer);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, arena->Buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, cast(u64) capacity * sizeof(Vertex), NULL, 0);
+}
+
+void VertexArena_Destroy(VertexArena* arena) {
+    GLState_DeleteBuffers(1, &arena->Buffer);
+    DynamicArrayDestroy(arena->FreeBlocks);
+    DynamicArrayDestroy(arena->RetiredBlocks);
+    for (u64 i = 0; i < DynamicArrayLength(arena->Fences); i++) {
+        glDeleteSync(arena->Fences[i].Sync);
+    }
+    DynamicArrayDestroy(arena->Fences);
+    *arena = (VertexArena){};
+}
+
+u32 VertexArena_Allocate(VertexArena* arena, u32 count) {
+    ASSERT(count > 0);
+
+    while (TRUE) {
+        // Best fit keeps the big blocks around for the big meshes
+        VertexArenaBlock* best = NULL;
+        for (u64 i = 0; i < DynamicArrayLength(arena->FreeBlocks); i++) {
+            VertexArenaBlock* block = &arena->FreeBlocks[i];
+            if (block->Count >= count && (!best || block->Count < best->Count)) {
+                best = block;
+                if (block->Count == count) {
+                    break;
+                }
+            }
+        }
+
+        if (best) {
+            u32 offset = best->Offset;
+            best->Offset += count;
+            best->Count -= count;
+            if (best->Count == 0) {
+                DynamicArrayPopAt(arena->FreeBlocks, cast(u64) (best - arena->FreeBlocks), NULL);
+            }
+            arena->Used += count;
+            return offset;
+        }
+
+        VertexArena_Grow(arena);
+    }
+}
+
+void VertexArena_Free(VertexArena* arena, u32 offset, u32 count) {
+    ASSERT(count > 0 && offset + count <= arena->Capacity);
+    VertexArena_InsertFreeBlock(arena, offset, count);
+    arena->Used -= count;
+}
+
+void VertexArena_Retire(VertexArena* arena, u32 offset, u32 count) {
+    ASSERT(count > 0 && offset + count <= arena->Capacity);
+    DynamicArrayPush(arena->RetiredBlocks, ((VertexArenaBlock){ offset, count }));
+}
+
+void VertexArena_Fence(VertexArena* arena) {
+    u64 freedBlockCount = 0;
+    while (DynamicArrayLength(arena->Fences) > 0) {
+        VertexArenaFence fence = arena->Fences[0];
+        GLenum result = glClientWaitSync(fence.Sync, 0, 0);
+        ASSERT(result != GL_WAIT_FAILED);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        for (u64 i = freedBlockCount; i < freedBlockCount + fence.BlockCount; i++) {
+            VertexArena_Free(arena, arena->RetiredBlocks[i].Offset, arena->RetiredBlocks[i].Count);
+        }
+        freedBlockCount += fence.BlockCount;
+        glDeleteSync(fence.Sync);
+        DynamicArrayPopAt(arena->Fences, 0, NULL);
+    }
+
+    if (freedBlockCount > 0) {
+        u64 remaining = DynamicArrayLength(arena->RetiredBlocks) - freedBlockCount;
+        memmove(arena->RetiredBlocks, &arena->RetiredBlocks[freedBlockCount], remaining * sizeof(VertexArenaBlock));
+        DynamicArrayLength(arena->RetiredBlocks) = remaining;
+        arena->FencedBlockCount -= freedBlockCount;
+    }
+
+    u64 unfencedBlockCount = DynamicArrayLength(arena->RetiredBlocks) - arena->FencedBlockCount;
+    if (unfencedBlockCount > 0) {
+        VertexArenaFence fence = {
+            .Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+            .BlockCount = unfencedBlockCount,
+        };
+        DynamicArrayPush(arena->Fences, fence);
+        arena->FencedBlockCount += unfencedBlockCount;
+    }
+}
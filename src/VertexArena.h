@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "OpenGL.h"
+
+typedef struct VertexArenaBlock {
+    u32 Offset;
+    u32 Count;
+} VertexArenaBlock;
+
+// Covers the oldest BlockCount retired blocks that don't have a fence yet when it was inserted
+typedef struct VertexArenaFence {
+    GLsync Sync;
+    u64 BlockCount;
+} VertexArenaFence;
+
+// One GL buffer of Vertex that many meshes are suballocated from, so they can share a vertex array and be drawn together.
+// The storage can't be written from the CPU, it is filled with GPU copies. Offsets and counts are in vertices
+typedef struct VertexArena {
+    GLuint Buffer;
+    u32 Capacity;
+    u32 Used;
+    VertexArenaBlock* FreeBlocks; // Sorted by offset, free blocks that touch are always merged
+    VertexArenaBlock* RetiredBlocks; // Oldest first, they still count as used until their fence is signaled
+    u64 FencedBlockCount;            // How many of the retired blocks are covered by Fences
+    VertexArenaFence* Fences;        // Oldest first
+} VertexArena;
+
+void VertexArena_Create(VertexArena* arena, u32 capacity);
+void VertexArena_Destroy(VertexArena* arena);
+
+// Returns the offset of count vertices. When nothing is big enough the arena grows, which moves everything
+// to a new arena->Buffer with the same offsets so anything that references the buffer has to be rebound
+u32 VertexArena_Allocate(VertexArena* arena, u32 count);
+void VertexArena_Free(VertexArena* arena, u32 offset, u32 count);
+// Frees the block once the GPU is done with the commands issued so far, so a new mesh is never copied over
+// one that an earlier frame's draw may still be reading
+void VertexArena_Retire(VertexArena* arena, u32 offset, u32 count);
+// Fences the blocks retired since the last call and frees the ones whose fence has been signaled without waiting
+// for the others, call once per frame
+void VertexArena_Fence(VertexArena* arena);